@@ -0,0 +1,3 @@
+Temporal_Map (1,1) K
+Spatial_Map (1,1) M
+Temporal_Map (8,8) N
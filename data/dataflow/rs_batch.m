@@ -0,0 +1,7 @@
+Temporal_Map (1,1) K
+Temporal_Map (1,1) C
+Temporal_Map (1,1) N
+Temporal_Map (3,1) Y
+Spatial_Map (3,1) X
+unroll R
+unroll S
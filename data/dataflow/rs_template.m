@@ -0,0 +1,7 @@
+Temporal_Map (Tk,Tk) K
+Temporal_Map (Tc,Tc) C
+Temporal_Map (Sz(R),1) Y
+Cluster (Cx) X
+Spatial_Map (Sz(S),1) X
+unroll R
+unroll S
@@ -0,0 +1,7 @@
+K 96
+C 3
+R 11
+S 11
+Y 227
+X 227
+Stride 4
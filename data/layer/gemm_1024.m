@@ -0,0 +1,7 @@
+M 1024
+N 1024
+K 1024
+Input_Tensor A (M,K)
+Input_Tensor B (K,N)
+Output_Tensor C (M,N)
+Reduction (K)
@@ -0,0 +1,9 @@
+C 32
+R 3
+S 3
+Y 112
+X 112
+Input_Tensor weight (C,R,S)
+Input_Tensor input (C,Y,X)
+Output_Tensor output (C,Y,X)
+Reduction (R,S)
@@ -0,0 +1,7 @@
+N 16
+K 64
+C 64
+R 3
+S 3
+Y 224
+X 224
@@ -0,0 +1,8 @@
+K 64
+C 64
+R 3
+S 3
+Y 224
+X 224
+Density weight 0.3
+Density input 0.5
@@ -0,0 +1,11 @@
+data/dataflow/nlr.m data/layer/vgg16_conv1.m
+data/dataflow/nlr.m data/layer/vgg16_conv2.m
+data/dataflow/rs.m data/layer/vgg16_conv3.m
+data/dataflow/rs.m data/layer/vgg16_conv4.m
+data/dataflow/rs.m data/layer/vgg16_conv5.m
+data/dataflow/rs.m data/layer/vgg16_conv6.m
+data/dataflow/rs.m data/layer/vgg16_conv7.m
+data/dataflow/ws.m data/layer/vgg16_conv8.m
+data/dataflow/ws.m data/layer/vgg16_conv9.m
+data/dataflow/ws.m data/layer/vgg16_conv10.m
+data/dataflow/ws.m data/layer/vgg16_conv11.m
@@ -0,0 +1,8 @@
+# PE array, NoC, and L2 options
+num_pes range 64 1024 64
+noc_bw log 8 256 2
+l2_size log 4096 1048576 4
+# Size of the map directive of K in the dataflow
+Map K list 1 2 4 8
+Constraint noc_bw <= num_pes
+Constraint l1_buffer_requirement <= 512
@@ -27,13 +27,19 @@ SOFTWARE.
 #include <map>
 #include <tuple>
 #include <algorithm>
+#include <memory>
+#include <stdexcept>
 
 #include "mapping-syntax.hpp"
 #include "program-syntax.hpp"
 #include "noc-model.hpp"
+#include "checked-arithmetic.hpp"
 
 namespace maestro {
 
+  // Bits of a tensor value unless the layer declares its precision
+  const int default_precision_bits = 8;
+
   class LoopInformation {
     protected:
       int loop_id_;
@@ -59,6 +65,9 @@ namespace maestro {
                                         % loop_var_
                                         % base_
                                         % bound_ );
+        if(incr_ != 1) {
+          ret += boost::str(boost::format(", increment: %d") % incr_);
+        }
         return ret;
       }
 
@@ -74,22 +83,387 @@ namespace maestro {
         return bound_;
       }
 
+      // Values the loop variable takes; a strided loop also visits a last, partial window
       int GetNumIter() {
-        int ret = (bound_ - base_) / incr_;
+        int ret = (bound_ - base_ + incr_ - 1) / incr_;
         return ret;
       }
 
+      void SetIncrement(int incr) {
+        incr_ = incr;
+      }
+
+      int GetIncrement() {
+        return incr_;
+      }
+
+      // The range the loop runs over, regardless of its increment
+      int GetExtent() {
+        return bound_ - base_;
+      }
+
   }; // End of class LoopInformation
 
+  enum class TensorClass {
+    INPUT,
+    OUTPUT
+  };
+
+  class TensorInformation {
+    protected:
+      std::string tensor_name_;
+      TensorClass tensor_class_;
+      std::list<std::string> variables_;
+
+    public:
+      TensorInformation(std::string tensor_name, TensorClass tensor_class, std::list<std::string> variables) :
+        tensor_name_(tensor_name),
+        tensor_class_(tensor_class),
+        variables_(variables)
+      {
+      }
+
+      std::string ToString() {
+        std::string ret = (tensor_class_ == TensorClass::INPUT)? "Input tensor " : "Output tensor ";
+        ret += tensor_name_ + " (";
+
+        bool is_first = true;
+        for(auto& var : variables_) {
+          ret += is_first? var : "," + var;
+          is_first = false;
+        }
+        ret += ")";
+
+        return ret;
+      }
+
+      std::string GetName() {
+        return tensor_name_;
+      }
+
+      TensorClass GetClass() {
+        return tensor_class_;
+      }
+
+      const std::list<std::string>& GetVariables() {
+        return variables_;
+      }
+  }; // End of class TensorInformation
+
+  /*
+   * The tensors an operator reads and writes, the loop variables that index each of them,
+   * and the variables its partial sums are reduced over.
+   * A layer without a description is a convolution.
+   */
+  class OperatorInformation {
+    protected:
+      std::list<std::shared_ptr<TensorInformation>> tensors_;
+      std::list<std::string> reduction_variables_;
+      std::list<std::tuple<std::string, std::string>> sliding_windows_;
+      std::string batch_variable_;
+      bool is_declared_;
+
+    public:
+      OperatorInformation() :
+        batch_variable_(""),
+        is_declared_(true)
+      {
+      }
+
+      static std::shared_ptr<OperatorInformation> CreateConvolution(bool has_batch) {
+        auto conv = std::make_shared<OperatorInformation>();
+
+        std::list<std::string> weight_vars = {"K","C","R","S"};
+        std::list<std::string> input_vars = {"C","Y","X"};
+        std::list<std::string> output_vars = {"K","Y","X"};
+
+        // Weights are shared by every sample of a batch
+        if(has_batch) {
+          input_vars.push_front("N");
+          output_vars.push_front("N");
+          conv->SetBatchVariable("N");
+        }
+
+        conv->AddTensor(std::make_shared<TensorInformation>("weight", TensorClass::INPUT, weight_vars));
+        conv->AddTensor(std::make_shared<TensorInformation>("input", TensorClass::INPUT, input_vars));
+        conv->AddTensor(std::make_shared<TensorInformation>("output", TensorClass::OUTPUT, output_vars));
+
+        conv->AddReductionVariable("C");
+        conv->AddReductionVariable("R");
+        conv->AddReductionVariable("S");
+
+        // Y and X index input rows and columns; a filter window of R by S slides over them
+        conv->AddSlidingWindow("Y", "R");
+        conv->AddSlidingWindow("X", "S");
+
+        conv->is_declared_ = false;
+
+        return conv;
+      }
+
+      std::string ToString() {
+        std::string ret = "";
+
+        for(auto& tensor : tensors_) {
+          ret += tensor->ToString() + "\n";
+        }
+
+        ret += "Reduction variables:";
+        for(auto& var : reduction_variables_) {
+          ret += " " + var;
+        }
+        ret += "\n";
+
+        return ret;
+      }
+
+      void AddTensor(std::shared_ptr<TensorInformation> tensor) {
+        tensors_.push_back(tensor);
+      }
+
+      void RemoveTensor(const std::string& tensor_name) {
+        tensors_.remove_if([&](std::shared_ptr<TensorInformation>& tensor) { return tensor->GetName() == tensor_name; });
+      }
+
+      void AddReductionVariable(std::string var) {
+        reduction_variables_.push_back(var);
+      }
+
+      void SetBatchVariable(std::string var) {
+        batch_variable_ = var;
+      }
+
+      // The filter variable filter_var slides over the values of var
+      void AddSlidingWindow(std::string var, std::string filter_var) {
+        sliding_windows_.push_back({var, filter_var});
+      }
+
+      std::list<std::tuple<std::string, std::string>> GetSlidingWindows() {
+        return sliding_windows_;
+      }
+
+      // False for the implicit convolution of layer files without tensor declarations
+      bool IsDeclared() {
+        return is_declared_;
+      }
+
+      const std::list<std::shared_ptr<TensorInformation>>& GetTensorInformation() {
+        return tensors_;
+      }
+
+      std::list<std::string> GetTensors() {
+        std::list<std::string> ret;
+        for(auto& tensor : tensors_) {
+          ret.push_back(tensor->GetName());
+        }
+        return ret;
+      }
+
+      std::list<std::string> GetInputTensors() {
+        std::list<std::string> ret;
+        for(auto& tensor : tensors_) {
+          if(tensor->GetClass() == TensorClass::INPUT) {
+            ret.push_back(tensor->GetName());
+          }
+        }
+        return ret;
+      }
+
+      std::list<std::string> GetOutputTensors() {
+        std::list<std::string> ret;
+        for(auto& tensor : tensors_) {
+          if(tensor->GetClass() == TensorClass::OUTPUT) {
+            ret.push_back(tensor->GetName());
+          }
+        }
+        return ret;
+      }
+
+      bool IsOutputTensor(const std::string& tensor_name) {
+        for(auto& tensor : tensors_) {
+          if(tensor->GetClass() == TensorClass::OUTPUT && tensor->GetName() == tensor_name) return true;
+        }
+        return false;
+      }
+
+      bool HasTensor(std::string tensor_name) {
+        for(auto& tensor : tensors_) {
+          if(tensor->GetName() == tensor_name) return true;
+        }
+        return false;
+      }
+
+      std::list<std::string> GetReductionVariables() {
+        return reduction_variables_;
+      }
+
+      bool IsReductionVariable(std::string var) {
+        return std::find(reduction_variables_.begin(), reduction_variables_.end(), var) != reduction_variables_.end();
+      }
+
+      std::string GetBatchVariable() {
+        return batch_variable_;
+      }
+
+      // Every variable that indexes a tensor, in the order of first appearance; one operation per point of this space
+      std::list<std::string> GetIterationVariables() {
+        std::list<std::string> ret;
+        for(auto& tensor : tensors_) {
+          for(auto& var : tensor->GetVariables()) {
+            if(std::find(ret.begin(), ret.end(), var) == ret.end()) {
+              ret.push_back(var);
+            }
+          }
+        }
+        return ret;
+      }
+  }; // End of class OperatorInformation
+
+  /*
+   * A filter variable sliding over a loop variable with a stride and a dilation.
+   * The loop iterates over window positions (its increment is the stride), and
+   * a window of n filter values covers (n-1) * dilation + 1 values of the input.
+   */
+  class SlidingWindow {
+    public:
+      SlidingWindow(std::string filter_var = "", int stride = 1, int dilation = 1) :
+        filter_var_(filter_var),
+        stride_(stride),
+        dilation_(dilation)
+      {
+      }
+
+      std::string GetFilterVariable() const {
+        return filter_var_;
+      }
+
+      int GetStride() const {
+        return stride_;
+      }
+
+      int GetDilation() const {
+        return dilation_;
+      }
+
+      long GetWindowExtent(long num_filter_values) const {
+        return CheckedAdd(CheckedMul(num_filter_values - 1, dilation_), 1);
+      }
+
+      /*
+       * Input values of a tile that spans num_positions window positions at stride 1
+       * (the convention of dataflow map sizes) and num_filter_values filter values:
+       * the outputs of the tile, one stride apart, plus the halo of the filter window
+       */
+      long GetFootprint(long num_positions, long num_filter_values) const {
+        long num_taps = std::min(num_positions, num_filter_values);
+        long num_outputs = num_positions - num_taps + 1;
+        return CheckedAdd(CheckedMul(num_outputs - 1, stride_), this->GetWindowExtent(num_taps));
+      }
+
+    protected:
+      std::string filter_var_;
+      int stride_;
+      int dilation_;
+  }; // End of class SlidingWindow
+
   class LoopInfoTable {
     protected:
       std::shared_ptr<std::vector<std::shared_ptr<LoopInformation>>> info_table_;
+      std::shared_ptr<OperatorInformation> operator_info_;
+      std::map<std::string, double> tensor_densities_;
+      std::map<std::string, int> tensor_precisions_;
+      std::map<std::string, int> partial_sum_precisions_;
+      std::map<std::string, SlidingWindow> sliding_windows_;
 
     public:
-      LoopInfoTable() {
+      LoopInfoTable() :
+        operator_info_(nullptr)
+      {
         info_table_ = std::make_shared<std::vector<std::shared_ptr<LoopInformation>>>();
       }
 
+      void SetOperator(std::shared_ptr<OperatorInformation> operator_info) {
+        operator_info_ = operator_info;
+      }
+
+      std::shared_ptr<OperatorInformation> GetOperator() {
+        if(operator_info_ == nullptr) {
+          return OperatorInformation::CreateConvolution(!this->FindLoops("N")->empty());
+        }
+        return operator_info_;
+      }
+
+      // Fraction of non-zero values of a tensor; tensors without a density are dense
+      void SetTensorDensity(std::string tensor_name, double density) {
+        tensor_densities_[tensor_name] = density;
+      }
+
+      void SetTensorDensities(std::map<std::string, double> densities) {
+        tensor_densities_ = densities;
+      }
+
+      std::map<std::string, double> GetTensorDensities() {
+        return tensor_densities_;
+      }
+
+      /*
+       * Bits of each value of a tensor. Partial sums of an output tensor can be wider than its
+       * final values (e.g., 32-bit accumulators for 8-bit outputs); they default to the same width.
+       */
+      void SetTensorPrecision(std::string tensor_name, int bits, int partial_sum_bits = 0) {
+        tensor_precisions_[tensor_name] = bits;
+        if(partial_sum_bits > 0) {
+          partial_sum_precisions_[tensor_name] = partial_sum_bits;
+        }
+      }
+
+      void SetTensorPrecisions(std::map<std::string, int> precisions, std::map<std::string, int> partial_sum_precisions) {
+        tensor_precisions_ = precisions;
+        partial_sum_precisions_ = partial_sum_precisions;
+      }
+
+      std::map<std::string, int> GetTensorPrecisions() {
+        return tensor_precisions_;
+      }
+
+      std::map<std::string, int> GetPartialSumPrecisions() {
+        return partial_sum_precisions_;
+      }
+
+      int GetTensorPrecision(const std::string& tensor_name) const {
+        auto it = tensor_precisions_.find(tensor_name);
+        return (it != tensor_precisions_.end())? it->second : default_precision_bits;
+      }
+
+      int GetPartialSumPrecision(const std::string& tensor_name) const {
+        auto it = partial_sum_precisions_.find(tensor_name);
+        return (it != partial_sum_precisions_.end())? it->second : this->GetTensorPrecision(tensor_name);
+      }
+
+      // Bytes of num_values values of bits each
+      static long GetBytes(long num_values, int bits) {
+        long num_bits = CheckedMul(num_values, static_cast<long>(bits));
+        return num_bits / 8 + ((num_bits % 8 != 0)? 1 : 0);
+      }
+
+      void SetSlidingWindow(std::string var, SlidingWindow window) {
+        sliding_windows_[var] = window;
+      }
+
+      void SetSlidingWindows(std::map<std::string, SlidingWindow> windows) {
+        sliding_windows_ = windows;
+      }
+
+      const std::map<std::string, SlidingWindow>& GetSlidingWindows() {
+        return sliding_windows_;
+      }
+
+      // nullptr if no filter slides over var
+      SlidingWindow* FindSlidingWindow(const std::string& var) {
+        auto it = sliding_windows_.find(var);
+        return (it != sliding_windows_.end())? &it->second : nullptr;
+      }
+
       std::string ToString() {
         std::string ret = "";
 
@@ -97,10 +471,38 @@ namespace maestro {
           ret += loop->ToString() + "\n";
         }
 
+        for(auto& density : tensor_densities_) {
+          ret += "Density " + density.first + ": " + std::to_string(density.second) + "\n";
+        }
+
+        for(auto& precision : tensor_precisions_) {
+          ret += "Precision " + precision.first + ": " + std::to_string(precision.second) + " bits";
+          if(partial_sum_precisions_.find(precision.first) != partial_sum_precisions_.end()) {
+            ret += ", partial sums " + std::to_string(partial_sum_precisions_.at(precision.first)) + " bits";
+          }
+          ret += "\n";
+        }
+
+        for(auto& window : sliding_windows_) {
+          if(window.second.GetStride() != 1 || window.second.GetDilation() != 1) {
+            ret += "Window " + window.second.GetFilterVariable() + " over " + window.first
+                   + ": stride " + std::to_string(window.second.GetStride())
+                   + ", dilation " + std::to_string(window.second.GetDilation()) + "\n";
+          }
+        }
+
         return ret;
       }
 
 
+      std::vector<std::shared_ptr<LoopInformation>>::iterator begin() const {
+        return info_table_->begin();
+      }
+
+      std::vector<std::shared_ptr<LoopInformation>>::iterator end() const {
+        return info_table_->end();
+      }
+
       void AddLoop(std::shared_ptr<LoopInformation> new_loop) {
         info_table_->push_back(new_loop);
       }
@@ -117,35 +519,99 @@ namespace maestro {
         return ret;
       }
 
+      // New version of the table with the loop at pos replaced; the other loops are shared
+      std::shared_ptr<LoopInfoTable> WithLoop(std::shared_ptr<LoopInformation> new_loop, int pos) const {
+        auto ret = std::make_shared<LoopInfoTable>(*this);
+        ret->info_table_ = std::make_shared<std::vector<std::shared_ptr<LoopInformation>>>(*info_table_);
+        ret->info_table_->at(pos) = new_loop;
+
+        return ret;
+      }
+
+      // First loop on loop_var, without building a list; nullptr if there is none
+      std::shared_ptr<LoopInformation> FindLoop(const std::string& loop_var) const {
+        for(auto& loop_info : *info_table_) {
+          if(loop_info->GetLoopVar() == loop_var) {
+            return loop_info;
+          }
+        }
+        return nullptr;
+      }
+
+      // Iterations of the loop nest; a strided loop steps over window positions
       long GetTotalIterations() {
       	long ret = 1;
 
       	for(auto& loop: *info_table_) {
-      		ret *= loop->GetBound();
+      		ret = CheckedMul(ret, static_cast<long>(loop->GetNumIter()));
       	}
 
       	return ret;
       }
 
+      /*
+       * Values var takes in the output. Y and X of the implicit convolution are input sizes, so
+       * only the positions where the whole (dilated) window fits, one stride apart, are computed.
+       */
+      long GetOutputBound(const std::string& var) {
+        auto loop = this->FindLoop(var);
+        long num_iter = (loop != nullptr)? loop->GetNumIter() : 1;
+
+        auto window = this->FindSlidingWindow(var);
+        if(window == nullptr || loop == nullptr || this->GetOperator()->IsDeclared()) {
+          return std::max(1L, num_iter);
+        }
+
+        auto filter_loop = this->FindLoop(window->GetFilterVariable());
+        long window_extent = window->GetWindowExtent((filter_loop != nullptr)? filter_loop->GetNumIter() : 1);
+        long bound = (loop->GetExtent() - window_extent) / window->GetStride() + 1;
+        return std::max(1L, bound);
+      }
+
+      /*
+       * Output positions of var as the cost model counts them: one per loop iteration (layer files
+       * describe unstrided windows with "same" padding), except that a strided or dilated window
+       * only computes the positions of GetOutputBound
+       */
+      long GetOutputPositions(const std::string& var) {
+        auto loop = this->FindLoop(var);
+        if(loop == nullptr) return 1;
+
+        auto window = this->FindSlidingWindow(var);
+        bool strided = (window != nullptr) && (window->GetStride() > 1 || window->GetDilation() > 1);
+        return strided? this->GetOutputBound(var) : static_cast<long>(loop->GetNumIter());
+      }
+
+      // Multiply-accumulates of the layer, as the cost model performs them
+      long GetTotalOps() {
+        long ret = 1;
+
+        for(auto& loop: *info_table_) {
+          ret = CheckedMul(ret, this->GetOutputPositions(loop->GetLoopVar()));
+        }
+
+        return ret;
+      }
+
   }; // End of class LoopInfoTable
 
+  /*
+   * Pragmas are stored as a contiguous array of PragmaEntry values; copying a table copies
+   * the array and shares the (never modified) variable names. The Pragma classes are a facade
+   * for building tables and for printing.
+   */
   class PragmaTable {
     public:
-      PragmaTable() {
-        pragma_table_ = std::make_shared<std::vector<std::shared_ptr<Pragma>>>();
+      PragmaTable() :
+        var_names_(std::make_shared<std::vector<std::string>>())
+      {
       }
 
       class iterator {
         public:
           iterator() = default;
-          iterator(std::shared_ptr<std::vector<std::shared_ptr<Pragma>>> ptr):
-            pragma_table_ptr_(ptr.get()),
-            pos_(0)
-          {
-          }
-
-          iterator(std::shared_ptr<std::vector<std::shared_ptr<Pragma>>> ptr, int pos):
-            pragma_table_ptr_(ptr.get()),
+          iterator(const PragmaTable* table, int pos):
+            table_(table),
             pos_(pos)
           {
           }
@@ -164,70 +630,152 @@ namespace maestro {
             return pos_ != other.pos_;
           }
 
-          const std::shared_ptr<Pragma>& operator*() const {
-            return (*pragma_table_ptr_)[pos_];
+          PragmaView operator*() const {
+            return table_->GetPragma(pos_);
           }
 
         private:
+          const PragmaTable* table_ = nullptr;
           int pos_ = 0;
-          std::vector<std::shared_ptr<Pragma>>* pragma_table_ptr_;
 
       };
 
       iterator begin() const {
-        return iterator(pragma_table_, 0);
+        return iterator(this, 0);
       }
 
       iterator end() const {
-        int num_entries = pragma_table_->size();
-        return iterator(pragma_table_, num_entries);
+        int num_entries = entries_.size();
+        return iterator(this, num_entries);
       }
 
       std::string ToString() {
         std::string ret = "";
 
-        for(auto& pragma : *pragma_table_) {
-          ret += pragma->ToString() + "\n";
+        for(auto pragma : *this) {
+          ret += pragma.ToString() + "\n";
         }
 
         return ret;
       }
 
       void AddPragma(std::shared_ptr<Pragma> prag) {
-        pragma_table_->push_back(prag);
+        entries_.push_back(this->CreateEntry(prag));
+      }
+
+      void AddPragma(const PragmaView& prag) {
+        auto new_entry = prag.GetEntry();
+        new_entry.var_id = this->GetVarId(prag.GetVarName());
+        entries_.push_back(new_entry);
       }
 
-      std::shared_ptr<std::list<std::shared_ptr<Pragma>>> FindPragma(std::string var_name) {
-        auto ret = std::make_shared<std::list<std::shared_ptr<Pragma>>>();
+      std::shared_ptr<std::list<PragmaView>> FindPragma(std::string var_name) const {
+        auto ret = std::make_shared<std::list<PragmaView>>();
 
-        for(auto& prg : *pragma_table_) {
-          if(prg->GetVarName() == var_name) {
-            ret->push_back(prg); // This is not a bug; Just IDE does not understand auto around here
+        for(auto prg : *this) {
+          if(prg.GetVarName() == var_name) {
+            ret->push_back(prg);
           }
         }
         return ret;
       }
 
-      std::shared_ptr<Pragma> GetPragma(int pos) {
-        std::shared_ptr<Pragma> ret = nullptr;
-        if(pos < pragma_table_->size()) {
-          ret = pragma_table_->at(pos);
+      // Position of the first pragma on var_name; -1 if there is none
+      int FindPragmaPos(const std::string& var_name) const {
+        for(int pos = 0; pos < static_cast<int>(entries_.size()); pos++) {
+          if((*var_names_)[entries_[pos].var_id] == var_name) {
+            return pos;
+          }
+        }
+        return -1;
+      }
+
+      // Throws std::out_of_range for a position outside the table (e.g., -1 from FindPragmaPos)
+      PragmaView GetPragma(int pos) const {
+        if(pos < 0 || pos >= static_cast<int>(entries_.size())) {
+          throw std::out_of_range("no pragma at position " + std::to_string(pos));
+        }
+        return PragmaView(&entries_[pos], var_names_.get());
+      }
+
+      const std::vector<PragmaEntry>& GetEntries() const {
+        return entries_;
+      }
+
+      int GetPragmaCounts() const {
+        return entries_.size();
+      }
+
+      // The smallest array that can hold one instance of every cluster in the dataflow
+      int GetMinNumPEs() const {
+        int min_num_pes = 1;
+        for(auto& entry : entries_) {
+          if(entry.cls == PragmaClass::TILE) {
+            min_num_pes *= entry.size;
+          }
         }
+        return min_num_pes;
+      }
+
+      /*
+       * Tables are not modified once they are handed out, so threads can share them.
+       * A modified mapping is a new version of the table.
+       */
+      std::shared_ptr<PragmaTable> WithPragma(const PragmaEntry& new_entry, int pos) const {
+        auto ret = std::make_shared<PragmaTable>(*this);
+        ret->entries_.at(pos) = new_entry;
 
         return ret;
       }
 
-      int GetPragmaCounts() {
-        return pragma_table_->size();
+      // A table of the same directives with new values; entries must refer to the variables of this table
+      std::shared_ptr<PragmaTable> WithEntries(std::vector<PragmaEntry> new_entries) const {
+        auto ret = std::make_shared<PragmaTable>();
+        ret->entries_ = std::move(new_entries);
+        ret->var_names_ = var_names_;
+
+        return ret;
       }
 
-      void SetPragma(std::shared_ptr<Pragma> new_prag, int pos) {
-      	pragma_table_->at(pos) = new_prag;
+      std::shared_ptr<PragmaTable> WithPragma(std::shared_ptr<Pragma> new_prag, int pos) const {
+        auto ret = std::make_shared<PragmaTable>(*this);
+        ret->entries_.at(pos) = ret->CreateEntry(new_prag);
+
+        return ret;
       }
 
     protected:
-      std::shared_ptr<std::vector<std::shared_ptr<Pragma>>> pragma_table_;
+      std::vector<PragmaEntry> entries_;
+      std::shared_ptr<const std::vector<std::string>> var_names_;
+
+      // Names are shared between versions of a table, so a new name goes to a new list
+      int GetVarId(const std::string& var_name) {
+        auto it = std::find(var_names_->begin(), var_names_->end(), var_name);
+        if(it != var_names_->end()) {
+          return it - var_names_->begin();
+        }
+
+        auto new_var_names = std::make_shared<std::vector<std::string>>(*var_names_);
+        new_var_names->push_back(var_name);
+        var_names_ = new_var_names;
 
+        return var_names_->size() - 1;
+      }
+
+      PragmaEntry CreateEntry(std::shared_ptr<Pragma> prag) {
+        PragmaEntry entry;
+        entry.cls = prag->GetClass();
+        entry.var_id = this->GetVarId(prag->GetVarName());
+        entry.size = prag->GetSize();
+        entry.offset = prag->GetOffset();
+
+        auto spatial_map = std::dynamic_pointer_cast<SpatialMap>(prag);
+        if(spatial_map != nullptr) {
+          entry.num_spatial_components = spatial_map->GetNumSpatialComponents();
+        }
+
+        return entry;
+      }
 
   }; // End of class PragmaTable
 
@@ -0,0 +1,282 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_BATCH_EVALUATOR_HPP_
+#define MAESTRO_BATCH_EVALUATOR_HPP_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "noc-model.hpp"
+#include "cost-analysis.hpp"
+#include "checked-arithmetic.hpp"
+
+namespace maestro {
+
+  /* Hardware configurations in structure-of-arrays layout */
+  class HardwareConfigBatch {
+    public:
+      std::vector<int> noc_bw;
+      std::vector<int> noc_hops;
+      std::vector<int> noc_hop_latency;
+      std::vector<int> num_alus_per_pe;
+
+      void AddConfig(int bw, int hops, int hop_latency, int alus) {
+        noc_bw.push_back(bw);
+        noc_hops.push_back(hops);
+        noc_hop_latency.push_back(hop_latency);
+        num_alus_per_pe.push_back(alus);
+      }
+
+      long GetSize() {
+        return static_cast<long>(noc_bw.size());
+      }
+  }; // End of class HardwareConfigBatch
+
+#if defined(__AVX512F__)
+  class SIMDLanes {
+    public:
+      using Vector = __m512d;
+      using Mask = __mmask8;
+      static const int num_lanes = 8;
+
+      static Vector Set(double val) { return _mm512_set1_pd(val); }
+      static Vector Load(const int* ptr) { return _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr))); }
+      static void Store(double* ptr, Vector a) { _mm512_storeu_pd(ptr, a); }
+      static Vector Add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+      static Vector Sub(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+      static Vector Mul(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+      static Vector Div(Vector a, Vector b) { return _mm512_div_pd(a, b); }
+      static Vector Max(Vector a, Vector b) { return _mm512_max_pd(a, b); }
+      static Vector Floor(Vector a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+      static Mask Less(Vector a, Vector b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+      static Mask GreaterEqual(Vector a, Vector b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+      static Mask Greater(Vector a, Vector b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+      static Vector Select(Mask m, Vector a, Vector b) { return _mm512_mask_blend_pd(m, b, a); }
+  }; // End of class SIMDLanes
+#elif defined(__AVX2__)
+  class SIMDLanes {
+    public:
+      using Vector = __m256d;
+      using Mask = __m256d;
+      static const int num_lanes = 4;
+
+      static Vector Set(double val) { return _mm256_set1_pd(val); }
+      static Vector Load(const int* ptr) { return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))); }
+      static void Store(double* ptr, Vector a) { _mm256_storeu_pd(ptr, a); }
+      static Vector Add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+      static Vector Sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+      static Vector Mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+      static Vector Div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+      static Vector Max(Vector a, Vector b) { return _mm256_max_pd(a, b); }
+      static Vector Floor(Vector a) { return _mm256_floor_pd(a); }
+      static Mask Less(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+      static Mask GreaterEqual(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+      static Mask Greater(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+      static Vector Select(Mask m, Vector a, Vector b) { return _mm256_blendv_pd(b, a, m); }
+  }; // End of class SIMDLanes
+#endif
+
+  /*
+   * Evaluates PerformanceAnalysis::GetRunTime for many NoC/ALU configurations that share one mapping.
+   * The SIMD lanes compute in double precision, which is exact for integers below 2^53;
+   * configurations whose runtime may not be exact, or that are invalid, fall back to the scalar model.
+   */
+  class BatchRuntimeEvaluator {
+    protected:
+      RuntimeTerms terms_;
+      bool is_vectorizable_;
+
+      static constexpr double exact_limit_ = 4503599627370496.0; // 2^52
+
+      long EvaluateScalar(int bw, int hops, int hop_latency, int alus) {
+        if(bw <= 0 || alus <= 0) return -1;
+
+        NetworkOnChipModel noc_model(bw, hops, hop_latency, true);
+        try {
+          return PerformanceAnalysis::GetRunTime(terms_, noc_model, alus);
+        }
+        catch(ArithmeticOverflow& e) {
+          return -1;
+        }
+      }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+      using V = SIMDLanes;
+
+      // ceil(amount / bw) for non-negative integers; the estimate from the reciprocal is off by at most one
+      static V::Vector CeilDiv(V::Vector amount, V::Vector bw, V::Vector bw_reciprocal) {
+        V::Vector q = V::Floor(V::Mul(amount, bw_reciprocal));
+        V::Vector r = V::Sub(amount, V::Mul(q, bw));
+
+        V::Vector one = V::Set(1.0);
+        q = V::Select(V::Less(r, V::Set(0.0)), V::Sub(q, one), q);
+        r = V::Select(V::Less(r, V::Set(0.0)), V::Add(r, bw), r);
+        q = V::Select(V::GreaterEqual(r, bw), V::Add(q, one), q);
+        r = V::Select(V::GreaterEqual(r, bw), V::Sub(r, bw), r);
+
+        return V::Select(V::Greater(r, V::Set(0.0)), V::Add(q, one), q);
+      }
+
+      // floor(amount / divisor) for non-negative integers
+      static V::Vector FloorDiv(V::Vector amount, V::Vector divisor) {
+        V::Vector q = V::Floor(V::Div(amount, divisor));
+        V::Vector r = V::Sub(amount, V::Mul(q, divisor));
+
+        V::Vector one = V::Set(1.0);
+        q = V::Select(V::Less(r, V::Set(0.0)), V::Sub(q, one), q);
+        r = V::Select(V::Less(r, V::Set(0.0)), V::Add(r, divisor), r);
+
+        return V::Select(V::GreaterEqual(r, divisor), V::Add(q, one), q);
+      }
+
+      // NetworkOnChipModel::GetOutStandingDelay
+      static V::Vector GetOutStandingDelay(long amount, V::Vector bw, V::Vector bw_reciprocal, V::Vector zero_load_delay) {
+        V::Vector num_sends = CeilDiv(V::Set(static_cast<double>(amount)), bw, bw_reciprocal);
+        return V::Add(zero_load_delay, V::Sub(num_sends, V::Set(1.0)));
+      }
+
+      // PerformanceAnalysis::GetInputDelay
+      V::Vector GetInputDelay(long amount, V::Vector bw, V::Vector bw_reciprocal, V::Vector zero_load_delay) {
+        V::Vector delay = GetOutStandingDelay(amount, bw, bw_reciprocal, zero_load_delay);
+        if(terms_.prefetch_depth <= 2) return delay;
+
+        double num_in_flight = terms_.prefetch_depth - 1;
+        V::Vector hidden_head_delay = CeilDiv(zero_load_delay, V::Set(num_in_flight), V::Set(1.0 / num_in_flight));
+        return V::Add(V::Sub(delay, zero_load_delay), hidden_head_delay);
+      }
+
+      V::Vector GetIterationDelay(V::Vector L2ToL1_delay, V::Vector L1ToL2_delay, V::Vector compute_delay) {
+        V::Vector dram_delay = V::Set(static_cast<double>(terms_.dram_delay));
+
+        if(terms_.latency_hiding) {
+          V::Vector zero = V::Set(0.0);
+          V::Vector pe_delay = terms_.drain_overlap? compute_delay : V::Add(L1ToL2_delay, compute_delay);
+          if(terms_.prefetch_depth <= 1) pe_delay = V::Add(pe_delay, L2ToL1_delay);
+
+          V::Vector delay = V::Max(terms_.prefetch_depth <= 1? zero : L2ToL1_delay, pe_delay);
+          delay = V::Max(delay, terms_.drain_overlap? L1ToL2_delay : zero);
+          return V::Max(delay, dram_delay);
+        }
+        else {
+          return V::Add(V::Add(L2ToL1_delay, compute_delay), V::Add(L1ToL2_delay, dram_delay));
+        }
+      }
+
+      void EvaluateLanes(const int* bw_ptr, const int* hops_ptr, const int* hop_latency_ptr, const int* alus_ptr, long* runtime) {
+        V::Vector bw = V::Load(bw_ptr);
+        V::Vector bw_reciprocal = V::Div(V::Set(1.0), bw);
+        V::Vector zero_load_delay = V::Mul(V::Load(hops_ptr), V::Load(hop_latency_ptr));
+
+        V::Vector compute_delay = FloorDiv(V::Set(static_cast<double>(terms_.num_ops_per_pe)), V::Load(alus_ptr));
+        compute_delay = V::Max(compute_delay, V::Set(1.0));
+
+        V::Vector L1ToL2_delay = GetOutStandingDelay(terms_.L1ToL2_traffic, bw, bw_reciprocal, zero_load_delay);
+        L1ToL2_delay = V::Add(L1ToL2_delay, V::Set(static_cast<double>(terms_.reduction_delay)));
+
+        V::Vector lane_runtime = GetOutStandingDelay(terms_.init_traffic, bw, bw_reciprocal, zero_load_delay);
+        lane_runtime = V::Add(lane_runtime, V::Set(static_cast<double>(terms_.init_dram_delay)));
+
+        if(terms_.num_sp_foldings > 2) {
+          V::Vector delay = GetIterationDelay(GetInputDelay(terms_.first_tp_steady_sp_traffic, bw, bw_reciprocal, zero_load_delay), L1ToL2_delay, compute_delay);
+          lane_runtime = V::Add(lane_runtime, V::Mul(V::Set(static_cast<double>(terms_.num_sp_foldings - 2)), delay));
+        }
+
+        lane_runtime = V::Add(lane_runtime, GetIterationDelay(GetInputDelay(terms_.first_tp_edge_sp_traffic, bw, bw_reciprocal, zero_load_delay), L1ToL2_delay, compute_delay));
+
+        V::Vector steady_delay = GetIterationDelay(GetInputDelay(terms_.steady_tp_steady_sp_traffic, bw, bw_reciprocal, zero_load_delay), L1ToL2_delay, compute_delay);
+        lane_runtime = V::Add(lane_runtime, V::Mul(V::Set(static_cast<double>(terms_.num_tp_foldings - 1) * static_cast<double>(terms_.num_sp_foldings - 1)), steady_delay));
+
+        V::Vector edge_delay = GetIterationDelay(GetInputDelay(terms_.steady_tp_edge_sp_traffic, bw, bw_reciprocal, zero_load_delay), L1ToL2_delay, compute_delay);
+        lane_runtime = V::Add(lane_runtime, V::Mul(V::Set(static_cast<double>(terms_.num_tp_foldings - 1)), edge_delay));
+
+        double lane_results[V::num_lanes];
+        V::Store(lane_results, lane_runtime);
+
+        for(int lane = 0; lane < V::num_lanes; lane++) {
+          if(bw_ptr[lane] <= 0 || alus_ptr[lane] <= 0) {
+            runtime[lane] = -1; // The lane divided by zero
+          }
+          else if(lane_results[lane] < exact_limit_ && lane_results[lane] > -exact_limit_) {
+            runtime[lane] = static_cast<long>(lane_results[lane]);
+          }
+          else {
+            runtime[lane] = this->EvaluateScalar(bw_ptr[lane], hops_ptr[lane], hop_latency_ptr[lane], alus_ptr[lane]);
+          }
+        }
+      }
+#endif
+
+    public:
+      BatchRuntimeEvaluator(RuntimeTerms terms) :
+        terms_(terms)
+      {
+        long max_term = std::max({terms_.num_ops_per_pe, terms_.init_traffic, terms_.L1ToL2_traffic,
+                                  terms_.first_tp_steady_sp_traffic, terms_.first_tp_edge_sp_traffic,
+                                  terms_.steady_tp_steady_sp_traffic, terms_.steady_tp_edge_sp_traffic,
+                                  terms_.init_dram_delay, terms_.dram_delay, terms_.reduction_delay});
+        double num_iterations = static_cast<double>(terms_.num_tp_foldings) * static_cast<double>(terms_.num_sp_foldings);
+        is_vectorizable_ = !terms_.fine_grained_sync && static_cast<double>(max_term) < exact_limit_ && num_iterations < exact_limit_;
+      }
+
+      static std::string GetInstructionSet() {
+#if defined(__AVX512F__)
+        return "avx512";
+#elif defined(__AVX2__)
+        return "avx2";
+#else
+        return "scalar";
+#endif
+      }
+
+      /*
+       * Writes the runtime of each configuration to runtime[0 .. num_configs-1].
+       * Invalid configurations (non-positive bandwidth or ALU count, or a runtime beyond 64 bits) get -1.
+       */
+      void Evaluate(long num_configs, const int* noc_bw, const int* noc_hops, const int* noc_hop_latency, const int* num_alus_per_pe, long* runtime) {
+        long idx = 0;
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+        if(is_vectorizable_) {
+          for(; idx + V::num_lanes <= num_configs; idx += V::num_lanes) {
+            this->EvaluateLanes(noc_bw + idx, noc_hops + idx, noc_hop_latency + idx, num_alus_per_pe + idx, runtime + idx);
+          }
+        }
+#endif
+
+        for(; idx < num_configs; idx++) {
+          runtime[idx] = this->EvaluateScalar(noc_bw[idx], noc_hops[idx], noc_hop_latency[idx], num_alus_per_pe[idx]);
+        }
+      }
+
+      std::vector<long> Evaluate(HardwareConfigBatch& batch) {
+        std::vector<long> runtime(batch.GetSize());
+        this->Evaluate(batch.GetSize(), batch.noc_bw.data(), batch.noc_hops.data(), batch.noc_hop_latency.data(), batch.num_alus_per_pe.data(), runtime.data());
+        return runtime;
+      }
+  }; // End of class BatchRuntimeEvaluator
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,57 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_CHECKED_ARITHMETIC_HPP_
+#define MAESTRO_CHECKED_ARITHMETIC_HPP_
+
+#include <stdexcept>
+
+namespace maestro {
+
+  /*
+   * A size, count, or delay of the analysis does not fit in 64 bits. The design point
+   * is reported as invalid rather than with a wrapped-around value.
+   */
+  class ArithmeticOverflow : public std::overflow_error {
+    public:
+      ArithmeticOverflow() :
+        std::overflow_error("[MAESTRO] Error; a size or delay of the design point exceeds 64-bit arithmetic")
+      {
+      }
+  }; // End of class ArithmeticOverflow
+
+  inline long CheckedMul(long a, long b) {
+    long ret;
+    if(__builtin_mul_overflow(a, b, &ret)) {
+      throw ArithmeticOverflow();
+    }
+    return ret;
+  }
+
+  inline long CheckedAdd(long a, long b) {
+    long ret;
+    if(__builtin_add_overflow(a, b, &ret)) {
+      throw ArithmeticOverflow();
+    }
+    return ret;
+  }
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,352 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_CHIPLET_ANALYSIS_HPP_
+#define MAESTRO_CHIPLET_ANALYSIS_HPP_
+
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "analysis-structure.hpp"
+#include "mapping-syntax.hpp"
+#include "checked-arithmetic.hpp"
+#include "layer-analysis.hpp"
+
+namespace maestro {
+
+  // Slices of the same size; all of them run on their own chiplet in parallel
+  class ChipletPartition {
+    public:
+      long num_positions = 0; // Values of the partitioned variable (outputs, for a sliding window) in each slice
+      int num_chiplets = 0;
+      std::shared_ptr<LayerAnalysis> layer;
+  }; // End of class ChipletPartition
+
+  /*
+   * A layer split along one loop variable across several chiplets, each with the PE array,
+   * NoC, and L2 of chiplet_layer, connected by an inter-chip link of interchip_bw bytes per
+   * cycle per chiplet and interchip_latency cycles per transfer. Each slice is analyzed as a
+   * layer of its own. Tensors start evenly spread over the chiplets:
+   *  - A tensor the variable does not index is needed whole by every chiplet, which fetches
+   *    the part the others hold before it computes.
+   *  - Splitting a sliding window variable (Y or X of a convolution) leaves a halo of
+   *    input rows each chiplet fetches from its neighbour.
+   *  - Splitting a variable the output does not depend on (C of a convolution) leaves partial
+   *    sums of every output on every chiplet; a ring reduce-scatter adds them up across chips.
+   * Chiplets exchange inputs, compute, reduce, and meet at a barrier, one after another.
+   */
+  class ChipletAnalysis {
+    protected:
+      std::shared_ptr<LayerAnalysis> chiplet_layer_;
+      std::shared_ptr<LoopInfoTable> loop_info_table_;
+      int num_chiplets_;
+      std::string partition_var_;
+      long interchip_bw_;
+      long interchip_latency_;
+
+      std::vector<ChipletPartition> partitions_;
+      int num_active_chiplets_;
+      bool valid_;
+
+      static long DivideRoundUp(long dividend, long divisor) {
+        return (divisor <= 0)? dividend : dividend / divisor + ((dividend % divisor != 0)? 1 : 0);
+      }
+
+      static bool HasVariable(std::shared_ptr<TensorInformation> tensor, const std::string& var) {
+        auto& vars = tensor->GetVariables();
+        return std::find(vars.begin(), vars.end(), var) != vars.end();
+      }
+
+      // The filter sliding over the partitioned variable, if the tensor is indexed by the window position only
+      SlidingWindow* FindFootprintWindow(std::shared_ptr<TensorInformation> tensor) {
+        auto window = loop_info_table_->FindSlidingWindow(partition_var_);
+        if(window == nullptr || tensor->GetClass() != TensorClass::INPUT
+           || !HasVariable(tensor, partition_var_) || HasVariable(tensor, window->GetFilterVariable())) {
+          return nullptr;
+        }
+        return window;
+      }
+
+      long GetWindowExtent(SlidingWindow* window) {
+        auto filter_loop = loop_info_table_->FindLoop(window->GetFilterVariable());
+        return window->GetWindowExtent((filter_loop != nullptr)? filter_loop->GetNumIter() : 1);
+      }
+
+      // Values of the tensor, leaving out the partitioned variable if exclude_partition_var
+      long GetNumValues(std::shared_ptr<TensorInformation> tensor, bool exclude_partition_var) {
+        long ret = 1;
+        for(auto& var : tensor->GetVariables()) {
+          if(exclude_partition_var && var == partition_var_) continue;
+
+          auto loop = loop_info_table_->FindLoop(var);
+          if(loop == nullptr) continue;
+
+          auto window = loop_info_table_->FindSlidingWindow(var);
+          bool is_footprint = window != nullptr && tensor->GetClass() == TensorClass::INPUT
+                              && !HasVariable(tensor, window->GetFilterVariable());
+          ret = CheckedMul(ret, static_cast<long>(is_footprint? loop->GetExtent() : loop->GetNumIter()));
+        }
+        return ret;
+      }
+
+      long GetInputBytes(const std::string& tensor_name, long num_values) {
+        int bits = loop_info_table_->GetTensorPrecision(tensor_name);
+        num_values = chiplet_layer_->GetSparsityModel()->GetCompressedSize(tensor_name, num_values, bits);
+        return LoopInfoTable::GetBytes(num_values, bits);
+      }
+
+      // Positions of the partitioned variable to split: outputs of a sliding window, or the loop iterations
+      long GetNumPositions() {
+        auto loop = loop_info_table_->FindLoop(partition_var_);
+        if(loop == nullptr) return 1;
+
+        auto window = loop_info_table_->FindSlidingWindow(partition_var_);
+        if(window == nullptr) return loop->GetNumIter();
+
+        return std::max(1L, (loop->GetExtent() - this->GetWindowExtent(window)) / window->GetStride() + 1);
+      }
+
+      // The mapping of a slice; maps of the partitioned variable cannot be larger than the slice
+      std::shared_ptr<PragmaTable> ClampMapSizes(std::shared_ptr<PragmaTable> prag_tbl, long extent) {
+        auto ret = prag_tbl;
+
+        int pos = 0;
+        for(auto prag : *prag_tbl) {
+          if(prag.GetVarName() == partition_var_
+             && (prag.GetClass() == PragmaClass::TEMPORAL_MAP || prag.GetClass() == PragmaClass::SPATIAL_MAP)) {
+            PragmaEntry new_entry = prag.GetEntry();
+            new_entry.size = static_cast<int>(std::min<long>(new_entry.size, extent));
+            new_entry.offset = static_cast<int>(std::min<long>(new_entry.offset, extent));
+            ret = ret->WithPragma(new_entry, pos);
+          }
+          pos++;
+        }
+
+        return ret;
+      }
+
+      void AddPartition(long num_positions, int num_chiplets) {
+        if(num_chiplets <= 0) return;
+
+        ChipletPartition partition;
+        partition.num_positions = num_positions;
+        partition.num_chiplets = num_chiplets;
+
+        if(num_active_chiplets_ == 1) {
+          partition.layer = chiplet_layer_->WithProblem(chiplet_layer_->GetPragmaTable(), loop_info_table_);
+        }
+        else {
+          int pos = 0;
+          for(auto& loop : *loop_info_table_) {
+            if(loop->GetLoopVar() == partition_var_) break;
+            pos++;
+          }
+
+          auto loop = loop_info_table_->FindLoop(partition_var_);
+          auto window = loop_info_table_->FindSlidingWindow(partition_var_);
+          long extent = (window != nullptr)?
+              CheckedAdd(CheckedMul(num_positions - 1, static_cast<long>(window->GetStride())), this->GetWindowExtent(window))
+              : CheckedMul(num_positions, static_cast<long>(loop->GetIncrement()));
+
+          auto slice_loop = std::make_shared<LoopInformation>(partition_var_, 0, static_cast<int>(extent));
+          slice_loop->SetIncrement(loop->GetIncrement());
+
+          partition.layer = chiplet_layer_->WithProblem(this->ClampMapSizes(chiplet_layer_->GetPragmaTable(), extent),
+                                                        loop_info_table_->WithLoop(slice_loop, pos));
+        }
+
+        partition.layer->Analyze();
+        if(!partition.layer->IsValid()) {
+          valid_ = false;
+        }
+
+        partitions_.push_back(partition);
+      }
+
+    public:
+      ChipletAnalysis(std::shared_ptr<LayerAnalysis> chiplet_layer, int num_chiplets, std::string partition_var,
+                      long interchip_bw, long interchip_latency) :
+        chiplet_layer_(chiplet_layer),
+        loop_info_table_(chiplet_layer->GetLoopInfoTable()),
+        num_chiplets_(num_chiplets),
+        partition_var_(partition_var),
+        interchip_bw_(interchip_bw),
+        interchip_latency_(interchip_latency),
+        num_active_chiplets_(1),
+        valid_(false)
+      {
+      }
+
+      // Like LayerAnalysis::Analyze, an overflow leaves the analysis invalid with a runtime of -1
+      void Analyze() {
+        partitions_.clear();
+        valid_ = true;
+
+        long num_positions = this->GetNumPositions();
+        num_active_chiplets_ = static_cast<int>(std::max(1L, std::min<long>(num_chiplets_, num_positions)));
+
+        long slice = num_positions / num_active_chiplets_;
+        int num_larger = static_cast<int>(num_positions % num_active_chiplets_);
+
+        try {
+          this->AddPartition(slice + 1, num_larger);
+          this->AddPartition(slice, num_active_chiplets_ - num_larger);
+          this->GetRuntime();
+        }
+        catch(ArithmeticOverflow& e) {
+          valid_ = false;
+        }
+      }
+
+      bool IsValid() {
+        return valid_;
+      }
+
+      std::string GetPartitionVariable() {
+        return partition_var_;
+      }
+
+      // Chiplets that get a slice; fewer than the chiplets if the variable has fewer values
+      int GetNumActiveChiplets() {
+        return num_active_chiplets_;
+      }
+
+      const std::vector<ChipletPartition>& GetPartitions() {
+        return partitions_;
+      }
+
+      // Bytes of an input tensor each chiplet receives from the others before it computes
+      long GetInputExchangeBytes(std::shared_ptr<TensorInformation> tensor) {
+        int n = num_active_chiplets_;
+        if(n <= 1 || tensor->GetClass() != TensorClass::INPUT) return 0;
+
+        if(!HasVariable(tensor, partition_var_)) {
+          long num_values = this->GetNumValues(tensor, false);
+          return this->GetInputBytes(tensor->GetName(), DivideRoundUp(CheckedMul(num_values, static_cast<long>(n - 1)), n));
+        }
+
+        auto window = this->FindFootprintWindow(tensor);
+        if(window != nullptr) {
+          long halo = this->GetWindowExtent(window) - window->GetStride();
+          if(halo > 0) {
+            return this->GetInputBytes(tensor->GetName(), CheckedMul(halo, this->GetNumValues(tensor, true)));
+          }
+        }
+
+        return 0;
+      }
+
+      // Partial sum bytes of an output tensor each chiplet holds before the cross-chip reduction
+      long GetPartialSumBytes(std::shared_ptr<TensorInformation> tensor) {
+        if(num_active_chiplets_ <= 1 || tensor->GetClass() != TensorClass::OUTPUT || HasVariable(tensor, partition_var_)) {
+          return 0;
+        }
+
+        return LoopInfoTable::GetBytes(this->GetNumValues(tensor, false), loop_info_table_->GetPartialSumPrecision(tensor->GetName()));
+      }
+
+      long GetInputExchangeDelay() {
+        long bytes = 0;
+        for(auto& tensor : loop_info_table_->GetOperator()->GetTensorInformation()) {
+          bytes = CheckedAdd(bytes, this->GetInputExchangeBytes(tensor));
+        }
+
+        return (bytes > 0)? CheckedAdd(DivideRoundUp(bytes, interchip_bw_), interchip_latency_) : 0;
+      }
+
+      // n - 1 steps of a ring; in each, every chiplet sends 1/n of its partial sums to the next one
+      long GetCrossChipReductionDelay() {
+        int n = num_active_chiplets_;
+
+        long bytes = 0;
+        for(auto& tensor : loop_info_table_->GetOperator()->GetTensorInformation()) {
+          bytes = CheckedAdd(bytes, this->GetPartialSumBytes(tensor));
+        }
+        if(bytes == 0) return 0;
+
+        long step_delay = CheckedAdd(DivideRoundUp(DivideRoundUp(bytes, n), interchip_bw_), interchip_latency_);
+        return CheckedMul(static_cast<long>(n - 1), step_delay);
+      }
+
+      // A barrier over a tree of the chiplets
+      long GetSynchronizationDelay() {
+        long num_levels = 0;
+        for(long reach = 1; reach < num_active_chiplets_; reach *= 2) {
+          num_levels++;
+        }
+        return CheckedMul(num_levels, interchip_latency_);
+      }
+
+      // The slowest slice
+      long GetComputeRuntime() {
+        long ret = 0;
+        for(auto& partition : partitions_) {
+          ret = std::max(ret, partition.layer->GetRuntime());
+        }
+        return ret;
+      }
+
+      long GetRuntime() {
+        if(!valid_) return -1;
+
+        long ret = this->GetComputeRuntime();
+        ret = CheckedAdd(ret, this->GetInputExchangeDelay());
+        ret = CheckedAdd(ret, this->GetCrossChipReductionDelay());
+        ret = CheckedAdd(ret, this->GetSynchronizationDelay());
+        return ret;
+      }
+
+      // Bytes over the inter-chip link, summed over the chiplets
+      long GetInterChipTraffic() {
+        int n = num_active_chiplets_;
+
+        long ret = 0;
+        for(auto& tensor : loop_info_table_->GetOperator()->GetTensorInformation()) {
+          ret = CheckedAdd(ret, CheckedMul(this->GetInputExchangeBytes(tensor), static_cast<long>(n - 1)));
+          ret = CheckedAdd(ret, CheckedMul(DivideRoundUp(this->GetPartialSumBytes(tensor), n), static_cast<long>(n) * (n - 1)));
+        }
+        return ret;
+      }
+
+      // Energy of the chiplets (in multiples of MAC energy); inter-chip transfers are reported as traffic
+      double GetEnergy() {
+        double ret = 0;
+        for(auto& partition : partitions_) {
+          ret += partition.num_chiplets * partition.layer->GetEnergy();
+        }
+        return ret;
+      }
+
+      // L2 buffer each chiplet needs for its slice
+      long GetL2BufferRequirement() {
+        long ret = 0;
+        for(auto& partition : partitions_) {
+          ret = std::max(ret, partition.layer->GetL2BufferRequirement());
+        }
+        return ret;
+      }
+
+  }; // End of class ChipletAnalysis
+
+}; // End of namespace maestro
+
+#endif
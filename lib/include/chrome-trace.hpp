@@ -0,0 +1,230 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_CHROME_TRACE_HPP_
+#define MAESTRO_CHROME_TRACE_HPP_
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+#include "cost-analysis.hpp"
+
+namespace maestro {
+
+  /*
+   * Writes the modeled schedule of a layer as a Chrome trace-event JSON file (Perfetto, chrome://tracing).
+   * One cycle is one microsecond of the trace. The first two temporal iterations are drawn fold by fold;
+   * the remaining ones are collapsed into a single span per track so that the trace size does not depend
+   * on the number of iterations.
+   */
+  class ChromeTraceWriter {
+    public:
+      ChromeTraceWriter(std::ostream& out) :
+        out_(out) {
+      }
+
+      void Write(const RuntimeBreakdown& breakdown, std::string layer_name) {
+        num_events_ = 0;
+        latency_hiding_ = breakdown.latency_hiding;
+        prefetch_depth_ = breakdown.prefetch_depth;
+        drain_overlap_ = breakdown.drain_overlap;
+
+        out_ << "{\"traceEvents\":[";
+        WriteMetadata("process_name", PHASE_TRACK, layer_name);
+        WriteMetadata("thread_name", PHASE_TRACK, "Phase");
+        WriteMetadata("thread_name", INPUT_NOC_TRACK, "Input NoC");
+        WriteMetadata("thread_name", COMPUTE_TRACK, "Compute");
+        WriteMetadata("thread_name", OUTPUT_NOC_TRACK, "Output NoC");
+        WriteMetadata("thread_name", DRAM_TRACK, "Off-chip");
+
+        long ts = 0;
+        auto init_phase = breakdown.FindPhase(RuntimePhaseClass::INITIAL_FILL);
+        if(init_phase != nullptr) {
+          WriteSpan(PHASE_TRACK, "Initial fill", ts, init_phase->iteration_delay, "");
+          // Off-chip data has to arrive before it can be distributed
+          WriteSpan(DRAM_TRACK, "Initial fill", ts, init_phase->dram_delay, "");
+          WriteSpan(INPUT_NOC_TRACK, "Initial fill", ts + init_phase->dram_delay, init_phase->noc_in_delay, "");
+          ts += init_phase->iteration_delay;
+        }
+
+        long num_tp_foldings = breakdown.num_tp_foldings;
+        long num_sp_foldings = breakdown.num_sp_foldings;
+
+        // Temporal iteration 0
+        long tp_begin = ts;
+        auto first_steady = breakdown.FindPhase(RuntimePhaseClass::FIRST_TP_STEADY_SP);
+        auto first_edge = breakdown.FindPhase(RuntimePhaseClass::FIRST_TP_EDGE_SP);
+        if(first_steady != nullptr) {
+          ts = WriteFolds(ts, *first_steady, first_steady->count, "Steady spatial fold");
+        }
+        if(first_edge != nullptr) {
+          ts = WriteFolds(ts, *first_edge, 1, "Edge spatial fold");
+        }
+        WriteSpan(PHASE_TRACK, "Temporal iteration 0", tp_begin, ts - tp_begin, "");
+
+        auto steady_steady = breakdown.FindPhase(RuntimePhaseClass::STEADY_TP_STEADY_SP);
+        auto steady_edge = breakdown.FindPhase(RuntimePhaseClass::STEADY_TP_EDGE_SP);
+        if(num_tp_foldings > 1 && steady_steady != nullptr && steady_edge != nullptr) {
+          // Temporal iteration 1; every later temporal iteration repeats it
+          tp_begin = ts;
+          ts = WriteFolds(ts, *steady_steady, num_sp_foldings - 1, "Steady spatial fold");
+          ts = WriteFolds(ts, *steady_edge, 1, "Edge spatial fold");
+          long tp_delay = ts - tp_begin;
+          WriteSpan(PHASE_TRACK, "Temporal iteration 1", tp_begin, tp_delay, "");
+
+          if(num_tp_foldings > 2) {
+            long num_iterations = num_tp_foldings - 2;
+            long dur = CheckedMul(num_iterations, tp_delay);
+            std::string name = "Temporal iterations 2-" + std::to_string(num_tp_foldings - 1);
+
+            WriteSpan(PHASE_TRACK, name, ts, dur, "\"iterations\":" + std::to_string(num_iterations)
+                      + ",\"cycles_per_iteration\":" + std::to_string(tp_delay));
+            auto busy_cycles = [&](long steady_delay, long edge_delay) {
+              return CheckedMul(num_iterations, CheckedAdd(CheckedMul(num_sp_foldings - 1, steady_delay), edge_delay));
+            };
+            WriteAggregate(INPUT_NOC_TRACK, name, ts, dur, num_iterations, busy_cycles(steady_steady->noc_in_delay, steady_edge->noc_in_delay));
+            WriteAggregate(COMPUTE_TRACK, name, ts, dur, num_iterations, busy_cycles(steady_steady->compute_delay, steady_edge->compute_delay));
+            WriteAggregate(OUTPUT_NOC_TRACK, name, ts, dur, num_iterations, busy_cycles(steady_steady->noc_out_delay, steady_edge->noc_out_delay));
+            WriteAggregate(DRAM_TRACK, name, ts, dur, num_iterations, busy_cycles(steady_steady->dram_delay, steady_edge->dram_delay));
+            ts += dur;
+          }
+        }
+
+        out_ << "],\"displayTimeUnit\":\"ns\",\"otherData\":{\"layer\":\"" << EscapeString(layer_name)
+             << "\",\"time_unit\":\"cycles\",\"runtime\":" << ts << "}}" << std::endl;
+      }
+
+      int GetNumEvents() {
+        return num_events_;
+      }
+
+    protected:
+      enum Track {
+        PHASE_TRACK = 0,
+        INPUT_NOC_TRACK = 1,
+        COMPUTE_TRACK = 2,
+        OUTPUT_NOC_TRACK = 3,
+        DRAM_TRACK = 4
+      };
+
+      std::ostream& out_;
+      int num_events_ = 0;
+      bool latency_hiding_ = true;
+      int prefetch_depth_ = 2;
+      bool drain_overlap_ = false;
+
+      static std::string EscapeString(const std::string& str) {
+        std::ostringstream escaped;
+        for(char c : str) {
+          if(c == '"' || c == '\\') {
+            escaped << '\\' << c;
+          }
+          else if(static_cast<unsigned char>(c) < 0x20) {
+            escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+          }
+          else {
+            escaped << c;
+          }
+        }
+        return escaped.str();
+      }
+
+      void BeginEvent() {
+        if(num_events_ > 0) out_ << ",";
+        out_ << std::endl;
+        num_events_++;
+      }
+
+      void WriteMetadata(std::string name, int tid, std::string value) {
+        BeginEvent();
+        out_ << "{\"name\":\"" << name << "\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << EscapeString(value) << "\"}}";
+      }
+
+      // A complete event; args is the body of its args object
+      void WriteSpan(int tid, std::string name, long ts, long dur, std::string args) {
+        if(dur <= 0) return;
+
+        BeginEvent();
+        out_ << "{\"name\":\"" << EscapeString(name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+             << ",\"ts\":" << ts << ",\"dur\":" << dur << ",\"args\":{" << args << "}}";
+      }
+
+      void WriteAggregate(int tid, std::string name, long ts, long dur, long num_iterations, long busy_cycles) {
+        if(busy_cycles <= 0) return;
+
+        std::ostringstream args;
+        args << "\"iterations\":" << num_iterations << ",\"busy_cycles\":" << busy_cycles
+             << ",\"utilization\":" << static_cast<double>(busy_cycles) / dur;
+        WriteSpan(tid, name, ts, dur, args.str());
+      }
+
+      /*
+       * One fold of phase: prefetched inputs stream in while computing, and outputs leave once the
+       * computation is done or, with drain overlap, while it runs
+       */
+      void WriteFold(long ts, const RuntimePhase& phase, std::string name) {
+        if(latency_hiding_) {
+          long compute_begin = (prefetch_depth_ <= 1)? ts + phase.noc_in_delay : ts;
+          WriteSpan(INPUT_NOC_TRACK, name, ts, phase.noc_in_delay, "");
+          WriteSpan(COMPUTE_TRACK, name, compute_begin, phase.compute_delay, "");
+          WriteSpan(OUTPUT_NOC_TRACK, name, drain_overlap_? ts : compute_begin + phase.compute_delay, phase.noc_out_delay, "");
+          WriteSpan(DRAM_TRACK, name, ts, phase.dram_delay, "");
+        }
+        else {
+          WriteSpan(DRAM_TRACK, name, ts, phase.dram_delay, "");
+          ts += phase.dram_delay;
+          WriteSpan(INPUT_NOC_TRACK, name, ts, phase.noc_in_delay, "");
+          ts += phase.noc_in_delay;
+          WriteSpan(COMPUTE_TRACK, name, ts, phase.compute_delay, "");
+          ts += phase.compute_delay;
+          WriteSpan(OUTPUT_NOC_TRACK, name, ts, phase.noc_out_delay, "");
+        }
+      }
+
+      // count folds of phase from ts: the first one in detail and the rest collapsed; returns the end time
+      long WriteFolds(long ts, const RuntimePhase& phase, long count, std::string name) {
+        if(count <= 0) return ts;
+
+        long dur = CheckedMul(count, phase.iteration_delay);
+        WriteSpan(PHASE_TRACK, count > 1? name + "s" : name, ts, dur, "\"folds\":" + std::to_string(count)
+                  + ",\"cycles_per_fold\":" + std::to_string(phase.iteration_delay)
+                  + ",\"bound\":\"" + GetRuntimeResourceName(phase.bound) + "\"");
+        WriteFold(ts, phase, name);
+
+        if(count > 1) {
+          long rest = count - 1;
+          long rest_begin = ts + phase.iteration_delay;
+          long rest_dur = dur - phase.iteration_delay;
+          std::string rest_name = name + "s (" + std::to_string(rest) + " more)";
+          WriteAggregate(INPUT_NOC_TRACK, rest_name, rest_begin, rest_dur, rest, CheckedMul(rest, phase.noc_in_delay));
+          WriteAggregate(COMPUTE_TRACK, rest_name, rest_begin, rest_dur, rest, CheckedMul(rest, phase.compute_delay));
+          WriteAggregate(OUTPUT_NOC_TRACK, rest_name, rest_begin, rest_dur, rest, CheckedMul(rest, phase.noc_out_delay));
+          WriteAggregate(DRAM_TRACK, rest_name, rest_begin, rest_dur, rest, CheckedMul(rest, phase.dram_delay));
+        }
+
+        return ts + dur;
+      }
+  }; // End of class ChromeTraceWriter
+
+}; // End of namespace maestro
+
+#endif
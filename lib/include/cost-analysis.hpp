@@ -29,16 +29,27 @@ SOFTWARE.
 #include <map>
 #include <tuple>
 #include <algorithm>
+#include <limits>
 
 #include "mapping-syntax.hpp"
 #include "program-syntax.hpp"
 #include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "reduction-network-model.hpp"
 #include "analysis-structure.hpp"
 #include "mapping-analysis.hpp"
+#include "lower-bound-analysis.hpp"
+#include "checked-arithmetic.hpp"
 
 
 namespace maestro {
 
+  /* Access energy of each component, relative to each other; buffer accesses are per byte */
+  const double l1_access_energy = 2.91;
+  const double l2_access_energy = 32.2;
+  const double mac_energy = 1.73;
+
 class BufferAnalysis {
     protected:
       std::shared_ptr<MappingAnalysis> map_analysis_;
@@ -51,37 +62,129 @@ class BufferAnalysis {
       long num_tp_foldings_;
       long num_sp_foldings_;
 
+      long l2_capacity_; // 0: unbounded L2
+      int prefetch_depth_; // Input tiles each PE can hold: the one in use and the ones being prefetched
+
+      std::shared_ptr<SparsityModel> sparsity_model_; // nullptr: every tensor is dense
+      std::shared_ptr<ReductionNetworkModel> reduction_model_; // nullptr: L2 accumulates the partial sums of every PE
+
+      // Bytes actually stored or moved for num_values values of the tensor
+      long GetStoredSize(std::string tensor_name, long num_values) {
+        int bits = map_analysis_->GetLoopInfoTable()->GetTensorPrecision(tensor_name);
+        if(sparsity_model_ != nullptr) {
+          num_values = sparsity_model_->GetCompressedSize(tensor_name, num_values, bits);
+        }
+
+        return LoopInfoTable::GetBytes(num_values, bits);
+      }
+
+      // Same as GetStoredSize, but partial sums of output tensors stay dense, at their own precision, while they are accumulated on chip
+      long GetStoredTileSize(std::string tensor_name, long num_values) {
+        if(map_analysis_->GetOperator()->IsOutputTensor(tensor_name)) {
+          return LoopInfoTable::GetBytes(num_values, map_analysis_->GetLoopInfoTable()->GetPartialSumPrecision(tensor_name));
+        }
+
+        return this->GetStoredSize(tensor_name, num_values);
+      }
+
     public:
       BufferAnalysis(std::shared_ptr<MappingAnalysis> map_analysis, std::shared_ptr<NetworkOnChipModel> noc_model, long num_pes) :
         map_analysis_(map_analysis),
         noc_model_(noc_model),
-        num_pes_(num_pes)
+        num_pes_(num_pes),
+        l2_capacity_(0),
+        prefetch_depth_(2),
+        sparsity_model_(nullptr),
+        reduction_model_(nullptr)
       {
         auto sp_tile_info = map_analysis->GetNumSpatialTiles();
-        num_sp_tiles_ = static_cast<long>(std::get<1>(sp_tile_info.front()));
+        num_sp_tiles_ = std::get<1>(sp_tile_info.front());
         num_tp_foldings_ = static_cast<long>(map_analysis->GetNumTemporalIterations());
-        num_sp_foldings_ = static_cast<long>(map_analysis->GetNumSpatialFoldings());
-        num_sp_edge_tiles_ = static_cast<long>(map_analysis->GetNumEdgeTiles());
+        num_sp_foldings_ = map_analysis->GetNumSpatialFoldings();
+        num_sp_edge_tiles_ = map_analysis->GetNumEdgeTiles();
         sp_tile_size_ = static_cast<long>(num_pes_) / num_sp_tiles_;
       }
 
-      int GetL1BufferRequiredSize(std::list<std::string> tensors, bool enable_double_buffering = true) {
-        int buff_size = 0;
+      void SetSparsityModel(std::shared_ptr<SparsityModel> sparsity_model) {
+        sparsity_model_ = sparsity_model;
+      }
+
+      std::shared_ptr<SparsityModel> GetSparsityModel() {
+        return sparsity_model_;
+      }
+
+      void SetReductionNetworkModel(std::shared_ptr<ReductionNetworkModel> reduction_model) {
+        reduction_model_ = reduction_model;
+      }
+
+      std::shared_ptr<ReductionNetworkModel> GetReductionNetworkModel() {
+        return reduction_model_;
+      }
+
+      // If the PEs of a spatial iteration produce partial sums of the same values of the tensor
+      bool IsSpatiallyReduced(std::string tensor_name) {
+        auto operator_info = map_analysis_->GetOperator();
+        return operator_info->IsOutputTensor(tensor_name) && operator_info->IsReductionVariable(map_analysis_->GetSpMapVariable());
+      }
+
+      bool IsReducedInNetwork(std::string tensor_name) {
+        if(reduction_model_ == nullptr || !reduction_model_->ReducesInNetwork()) return false;
+
+        return this->IsSpatiallyReduced(tensor_name);
+      }
+
+      // Cycles the reduction network spends on the partial sums of the tensor in a spatial iteration
+      long GetReductionDelay(std::string tensor_name, bool sp_iteration_edge = false) {
+        if(!this->IsReducedInNetwork(tensor_name)) return 0;
+
+        long num_senders = sp_iteration_edge? num_sp_edge_tiles_ : num_sp_tiles_;
+        return reduction_model_->GetReductionDelay(num_senders, this->GetStoredTileSize(tensor_name, map_analysis_->GetMappedSize(tensor_name, true, true)));
+      }
+
+      // Partial sums accumulated across the PEs of spatial iterations over the entire layer, in the network or in L2
+      long GetSpatialReductions(std::string tensor_name) {
+        if(!this->IsSpatiallyReduced(tensor_name)) return 0;
+
+        long unique_volume = map_analysis_->GetMappedSize(tensor_name, true, true);
+        long steady_sp_reductions = CheckedMul(num_sp_tiles_-1, unique_volume);
+        long edge_sp_reductions = CheckedMul(num_sp_edge_tiles_-1, unique_volume);
+
+        return CheckedMul(num_tp_foldings_, CheckedAdd(CheckedMul(num_sp_foldings_-1, steady_sp_reductions), edge_sp_reductions));
+      }
+
+      void SetPrefetchDepth(int prefetch_depth) {
+        prefetch_depth_ = prefetch_depth;
+      }
+
+      int GetPrefetchDepth() {
+        return prefetch_depth_;
+      }
+
+      /*
+       * With prefetching, each input tile is stored prefetch_depth_ times, and output tiles are
+       * double buffered so that a fold can accumulate while the previous one is collected
+       */
+      long GetL1BufferRequiredSize(const std::list<std::string>& tensors, bool enable_prefetching = true) {
+        long buff_size = 0;
         for(auto& tensor_name : tensors) {
-          buff_size += map_analysis_->GetMappedSize(tensor_name, false, false);
+          long tile_size = this->GetStoredTileSize(tensor_name, map_analysis_->GetMappedSize(tensor_name, false, false));
+          if(enable_prefetching) {
+            tile_size = CheckedMul(map_analysis_->GetOperator()->IsOutputTensor(tensor_name)? 2 : prefetch_depth_, tile_size);
+          }
+          buff_size = CheckedAdd(buff_size, tile_size);
         }
-        buff_size = enable_double_buffering? 2 * buff_size : buff_size; // Double buffering
         return buff_size;
       }
 
-      int GetL2BufferRequiredSize(std::list<std::string> tensors) {
-        int buff_size = 0;
+      long GetL2BufferRequiredSize(const std::list<std::string>& tensors) {
+        long buff_size = 0;
 
         for(auto& tensor_name : tensors) {
-          int first_pe_sp_data = map_analysis_->GetMappedSize(tensor_name, false, false);
-          int other_pe_sp_data = map_analysis_->GetMappedSize(tensor_name, false, true); // Consider spatial reuse
-          int num_max_pes = (num_sp_foldings_ == 1)? num_sp_edge_tiles_ : num_sp_tiles_;
-          buff_size += first_pe_sp_data + (num_max_pes-1) * other_pe_sp_data;
+          long first_pe_sp_data = map_analysis_->GetMappedSize(tensor_name, false, false);
+          long other_pe_sp_data = map_analysis_->GetMappedSize(tensor_name, false, true); // Consider spatial reuse
+          long num_max_pes = (num_sp_foldings_ == 1)? num_sp_edge_tiles_ : num_sp_tiles_;
+          long sp_data = CheckedAdd(first_pe_sp_data, CheckedMul(num_max_pes-1, other_pe_sp_data));
+          buff_size = CheckedAdd(buff_size, this->GetStoredTileSize(tensor_name, sp_data));
         }
 
         return buff_size;
@@ -91,9 +194,13 @@ class BufferAnalysis {
         long L1ToL2Traffic;
 
         long unique_volume = static_cast<long>(map_analysis_->GetMappedSize(tensor_name, enable_temporal_reuse, enable_spatial_reuse));
-        L1ToL2Traffic = sp_iteration_edge? num_sp_edge_tiles_ * unique_volume : num_sp_tiles_ * unique_volume;
+        long num_senders = sp_iteration_edge? num_sp_edge_tiles_ : num_sp_tiles_;
+        if(this->IsReducedInNetwork(tensor_name)) {
+          num_senders = 1; // Only the last stage of the reduction network sends the outputs
+        }
+        L1ToL2Traffic = CheckedMul(num_senders, unique_volume);
 
-        return L1ToL2Traffic;
+        return this->GetStoredTileSize(tensor_name, L1ToL2Traffic);
       }
 
       long GetSpatialL2ToL1Traffic(std::string target_tensor, bool first_tp_iteration, bool sp_iteration_edge, bool enable_temporal_reuse = true, bool enable_spatial_reuse = true) {
@@ -111,10 +218,10 @@ class BufferAnalysis {
         long steady_tp_first_sp_unit_L2Rd = static_cast<long>(map_analysis_->GetMappedSize(target_tensor, enable_temporal_reuse, false));
         long steady_tp_steady_sp_unit_L2Rd = static_cast<long>(map_analysis_->GetMappedSize(target_tensor, enable_temporal_reuse, enable_spatial_reuse));
 
-        long first_tp_steady_sp_L2Rd = (first_tp_first_sp_unit_L2Rd + (num_sp_tiles_-1) * first_tp_steady_sp_unit_L2Rd);
-        long first_tp_edge_sp_L2Rd =  (first_tp_first_sp_unit_L2Rd + (num_sp_edge_tiles_-1) * first_tp_steady_sp_unit_L2Rd);
-        long steady_tp_steady_sp_L2Rd = (steady_tp_first_sp_unit_L2Rd + (num_sp_tiles_-1) * steady_tp_steady_sp_unit_L2Rd);
-        long steady_tp_edge_sp_L2Rd = (steady_tp_first_sp_unit_L2Rd + (num_sp_edge_tiles_-1) * steady_tp_steady_sp_unit_L2Rd);
+        long first_tp_steady_sp_L2Rd = CheckedAdd(first_tp_first_sp_unit_L2Rd, CheckedMul(num_sp_tiles_-1, first_tp_steady_sp_unit_L2Rd));
+        long first_tp_edge_sp_L2Rd = CheckedAdd(first_tp_first_sp_unit_L2Rd, CheckedMul(num_sp_edge_tiles_-1, first_tp_steady_sp_unit_L2Rd));
+        long steady_tp_steady_sp_L2Rd = CheckedAdd(steady_tp_first_sp_unit_L2Rd, CheckedMul(num_sp_tiles_-1, steady_tp_steady_sp_unit_L2Rd));
+        long steady_tp_edge_sp_L2Rd = CheckedAdd(steady_tp_first_sp_unit_L2Rd, CheckedMul(num_sp_edge_tiles_-1, steady_tp_steady_sp_unit_L2Rd));
 
         if(is_multcast_supported) {
           if(first_tp_iteration && !sp_iteration_edge) {
@@ -132,14 +239,14 @@ class BufferAnalysis {
         }
         else {
           if(!sp_iteration_edge) {
-            L2ToL1Traffic = num_sp_tiles_ * non_reuse_unit_L2Rd/tp_change_freq;
+            L2ToL1Traffic = CheckedMul(num_sp_tiles_, non_reuse_unit_L2Rd)/tp_change_freq;
           }
           else {
-            L2ToL1Traffic = num_sp_edge_tiles_ * non_reuse_unit_L2Rd/tp_change_freq;
+            L2ToL1Traffic = CheckedMul(num_sp_edge_tiles_, non_reuse_unit_L2Rd)/tp_change_freq;
           }
         }
 
-         return L2ToL1Traffic;
+         return this->GetStoredTileSize(target_tensor, L2ToL1Traffic);
       } // End of GetSpatialL2ToL1Traffic
 
       long GetL2BufferRead(std::string target_tensor, bool enable_temporal_reuse = true, bool enable_spatial_reuse = true) {
@@ -150,10 +257,10 @@ class BufferAnalysis {
         long steady_tp_steady_sp_L2Rd = this->GetSpatialL2ToL1Traffic(target_tensor, false, false, enable_temporal_reuse, enable_spatial_reuse);
         long steady_tp_edge_sp_L2Rd = this->GetSpatialL2ToL1Traffic(target_tensor, false, true, enable_temporal_reuse, enable_spatial_reuse);
 
-        long first_tp_L2Rd = first_tp_edge_sp_L2Rd + (num_sp_foldings_-1) * first_tp_steady_sp_L2Rd;
-        long steady_tp_L2Rd = steady_tp_edge_sp_L2Rd + (num_sp_foldings_-1) * steady_tp_steady_sp_L2Rd;
+        long first_tp_L2Rd = CheckedAdd(first_tp_edge_sp_L2Rd, CheckedMul(num_sp_foldings_-1, first_tp_steady_sp_L2Rd));
+        long steady_tp_L2Rd = CheckedAdd(steady_tp_edge_sp_L2Rd, CheckedMul(num_sp_foldings_-1, steady_tp_steady_sp_L2Rd));
 
-        L2Rd = first_tp_L2Rd + (num_tp_foldings_-1) * steady_tp_L2Rd;
+        L2Rd = CheckedAdd(first_tp_L2Rd, CheckedMul(num_tp_foldings_-1, steady_tp_L2Rd));
 
         return L2Rd;
       } // End of GetL2BufferRead
@@ -161,29 +268,169 @@ class BufferAnalysis {
 
       long GetL2BufferWrite(std::string target_tensor, bool enable_temporal_reuse = true, bool enable_spatial_reuse = true) {
         //TODO: Extend it to non-reuse cases
-        long L2Wr = map_analysis_->GetFullSize(target_tensor); //Currently assumes full reuse
+        long L2Wr = this->GetStoredSize(target_tensor, map_analysis_->GetFullSize(target_tensor)); //Currently assumes full reuse
         //TODO: Manage output counts
 
         return L2Wr;
       }
 
+      void SetL2Capacity(long l2_capacity) {
+        l2_capacity_ = l2_capacity;
+      }
+
+      long GetL2Capacity() {
+        return l2_capacity_;
+      }
+
+      // The L2 size that keeps every tensor on chip for the entire layer
+      long GetL2Footprint(const std::list<std::string>& tensors) {
+        long footprint = 0;
+
+        for(auto& tensor_name : tensors) {
+          footprint = CheckedAdd(footprint, this->GetStoredSize(tensor_name, map_analysis_->GetFullSize(tensor_name)));
+        }
+
+        return footprint;
+      }
+
+      /*
+       * Fraction of the reuse across temporal iterations that the L2 captures.
+       * 1.0: Every value is fetched from DRAM exactly once
+       * 0.0: L2 only stages the working set of a single iteration; every L2 read refetches from DRAM
+       * Between the two, the reuse captured scales linearly with the capacity beyond the working set.
+       */
+      double GetL2ReuseRatio(const std::list<std::string>& tensors) {
+        return this->GetL2ReuseRatio(this->GetL2Footprint(tensors), static_cast<long>(this->GetL2BufferRequiredSize(tensors)));
+      }
+
+      // Footprint and working set are sums over tensors, so a tensor set can be evaluated without building its list
+      double GetL2ReuseRatio(long footprint, long working_set) {
+        if(l2_capacity_ <= 0 || l2_capacity_ >= footprint) {
+          return 1.0;
+        }
+
+        if(l2_capacity_ <= working_set || footprint <= working_set) {
+          return 0.0;
+        }
+
+        return static_cast<double>(l2_capacity_ - working_set) / static_cast<double>(footprint - working_set);
+      }
+
+      bool IsL2Overflowed(const std::list<std::string>& tensors) {
+        return this->GetL2ReuseRatio(tensors) < 1.0;
+      }
+
+      // Total partial sums sent from L1 to L2 over the entire layer
+      long GetL1ToL2Traffic(std::string target_tensor) {
+        long steady_sp_L1ToL2 = this->GetSpatialL1ToL2Traffic(target_tensor, false);
+        long edge_sp_L1ToL2 = this->GetSpatialL1ToL2Traffic(target_tensor, true);
+
+        long L1ToL2 = CheckedMul(num_tp_foldings_, CheckedAdd(CheckedMul(num_sp_foldings_-1, steady_sp_L1ToL2), edge_sp_L1ToL2));
+
+        return L1ToL2;
+      }
+
+      // DRAM reads of an input tensor: compulsory traffic plus refetches of the reuse that did not fit in L2
+      long GetDRAMRead(std::string target_tensor, const std::list<std::string>& tensors) {
+        return this->GetDRAMRead(target_tensor, this->GetL2ReuseRatio(tensors));
+      }
+
+      long GetDRAMRead(std::string target_tensor, double reuse_ratio) {
+        long compulsory = this->GetStoredSize(target_tensor, map_analysis_->GetFullSize(target_tensor));
+        long l2_reads = std::max(this->GetL2BufferRead(target_tensor), compulsory);
+
+        long refetch = static_cast<long>(static_cast<double>(l2_reads - compulsory) * (1.0 - reuse_ratio));
+
+        return CheckedAdd(compulsory, refetch);
+      }
+
+      // DRAM writes of an output tensor: final outputs (compressed if sparse) plus partial sums spilled out of L2
+      long GetDRAMWrite(std::string target_tensor, const std::list<std::string>& tensors) {
+        return this->GetDRAMWrite(target_tensor, this->GetL2ReuseRatio(tensors));
+      }
+
+      long GetDRAMWrite(std::string target_tensor, double reuse_ratio) {
+        long compulsory = this->GetStoredSize(target_tensor, map_analysis_->GetFullSize(target_tensor));
+
+        return CheckedAdd(compulsory, this->GetDRAMPartialSumRead(target_tensor, reuse_ratio));
+      }
+
+      // Spilled partial sums are read back before they are accumulated
+      long GetDRAMPartialSumRead(std::string target_tensor, const std::list<std::string>& tensors) {
+        return this->GetDRAMPartialSumRead(target_tensor, this->GetL2ReuseRatio(tensors));
+      }
+
+      long GetDRAMPartialSumRead(std::string target_tensor, double reuse_ratio) {
+        long compulsory = this->GetStoredTileSize(target_tensor, map_analysis_->GetFullSize(target_tensor));
+        long l2_writes = std::max(this->GetL1ToL2Traffic(target_tensor), compulsory);
+
+        long spill = static_cast<long>(static_cast<double>(l2_writes - compulsory) * (1.0 - reuse_ratio));
+
+        return spill;
+      }
+
+      long GetDRAMTraffic(const std::list<std::string>& input_tensors, const std::list<std::string>& output_tensors) {
+        long footprint = CheckedAdd(this->GetL2Footprint(input_tensors), this->GetL2Footprint(output_tensors));
+        long working_set = CheckedAdd(this->GetL2BufferRequiredSize(input_tensors), this->GetL2BufferRequiredSize(output_tensors));
+        double reuse_ratio = this->GetL2ReuseRatio(footprint, working_set);
+
+        long traffic = 0;
+        for(auto& in_tensor_name : input_tensors) {
+          traffic = CheckedAdd(traffic, this->GetDRAMRead(in_tensor_name, reuse_ratio));
+        }
+        for(auto& out_tensor_name : output_tensors) {
+          traffic = CheckedAdd(traffic, this->GetDRAMWrite(out_tensor_name, reuse_ratio));
+          traffic = CheckedAdd(traffic, this->GetDRAMPartialSumRead(out_tensor_name, reuse_ratio));
+        }
+
+        return traffic;
+      }
+
       long GetL1BufferRead(std::string target_tensor) {
         long L1Rd ;
 
-        long sp_read_volume = static_cast<long>(map_analysis_->GetMappedSize(target_tensor, false, false));
+        long sp_read_volume = this->GetStoredTileSize(target_tensor, map_analysis_->GetMappedSize(target_tensor, false, false));
 
-        long steady_sp_iteration_L1Rd = sp_tile_size_ * num_sp_tiles_ * sp_read_volume;
-        long edge_sp_iteration_L1Rd = sp_tile_size_ * num_sp_edge_tiles_  * sp_read_volume;
+        long steady_sp_iteration_L1Rd = CheckedMul(CheckedMul(sp_tile_size_, num_sp_tiles_), sp_read_volume);
+        long edge_sp_iteration_L1Rd = CheckedMul(CheckedMul(sp_tile_size_, num_sp_edge_tiles_), sp_read_volume);
 
-        L1Rd = num_tp_foldings_ * ((num_sp_foldings_-1) * steady_sp_iteration_L1Rd + edge_sp_iteration_L1Rd);
+        L1Rd = CheckedMul(num_tp_foldings_, CheckedAdd(CheckedMul(num_sp_foldings_-1, steady_sp_iteration_L1Rd), edge_sp_iteration_L1Rd));
 
         return L1Rd;
       }
 
 
+      /*
+       * L1 and L2 access energy of the listed tensors, in the unit of l1_access_energy/l2_access_energy per byte.
+       * Partial sums of spatially reduced outputs cost an addition each in the reduction network, or
+       * an L2 read and write each if L2 accumulates them.
+       */
+      double GetAccessEnergy(const std::list<std::string>& tensors) {
+        double l1_energy = 0.0;
+        double l2_energy = 0.0;
+        double reduction_energy = 0.0;
+
+        for(auto& tensor_name : tensors) {
+          l1_energy += this->GetL1BufferRead(tensor_name);
+          l1_energy += this->GetL1BufferWrite(tensor_name, true, true);
+
+          l2_energy += this->GetL2BufferRead(tensor_name);
+          l2_energy += this->GetL2BufferWrite(tensor_name, true, true);
+
+          if(this->IsReducedInNetwork(tensor_name)) {
+            reduction_energy += this->GetSpatialReductions(tensor_name) * reduction_model_->GetAddEnergy() * mac_energy;
+          }
+          else {
+            l2_energy += 2.0 * this->GetStoredTileSize(tensor_name, this->GetSpatialReductions(tensor_name));
+          }
+        }
+
+        return l1_energy * l1_access_energy + l2_energy * l2_access_energy + reduction_energy;
+      }
+
       double GetTemporalReuse(std::string target_tensor){
           long L1Rd = this->GetL1BufferRead(target_tensor);
-          long total_volume = map_analysis_->GetFullSize(target_tensor);
+          long total_volume = LoopInfoTable::GetBytes(map_analysis_->GetFullSize(target_tensor), map_analysis_->GetLoopInfoTable()->GetTensorPrecision(target_tensor));
 
           double reuse = (L1Rd / (double) (total_volume));
           return reuse;
@@ -200,7 +447,7 @@ class BufferAnalysis {
 
         if(noc_model_->IsMulticastSupported()) {
           long multcast_factor = map_analysis_->GetMappedSize(target_tensor, false ,false) / map_analysis_->GetMappedSize(target_tensor, false ,true);
-          L1Wr *= multcast_factor;
+          L1Wr = CheckedMul(L1Wr, multcast_factor);
         }
 
         return L1Wr;
@@ -208,14 +455,167 @@ class BufferAnalysis {
 
   }; // End of class BufferAnalysis
 
+  class RuntimeTerms {
+    public:
+      bool fine_grained_sync = false;
+      bool latency_hiding = true;
+      int prefetch_depth = 2;     // 1: inputs arrive only after the previous fold; 2: double buffering
+      bool drain_overlap = false; // If outputs leave while the next fold computes
+
+      long num_tp_foldings = 1;
+      long num_sp_foldings = 1;
+      long num_ops_per_pe = 1;
+
+      long init_traffic = 0;
+      long L1ToL2_traffic = 0;
+      long first_tp_steady_sp_traffic = 0;
+      long first_tp_edge_sp_traffic = 0;
+      long steady_tp_steady_sp_traffic = 0;
+      long steady_tp_edge_sp_traffic = 0;
+
+      long init_dram_delay = 0;
+      long dram_delay = 0;
+      long reduction_delay = 0; // Spent in the reduction network before the outputs are sent
+  }; // End of class RuntimeTerms
+
+  enum class RuntimeResource {
+    NOC_IN,  // L2 to L1 distribution of inputs
+    NOC_OUT, // L1 to L2 collection of outputs
+    COMPUTE,
+    DRAM
+  };
+
+  inline std::string GetRuntimeResourceName(RuntimeResource resource) {
+    switch(resource) {
+      case RuntimeResource::NOC_IN: return "Input NoC";
+      case RuntimeResource::NOC_OUT: return "Output NoC";
+      case RuntimeResource::COMPUTE: return "Compute";
+      default: return "DRAM";
+    }
+  }
+
+  enum class RuntimePhaseClass {
+    INITIAL_FILL,
+    FIRST_TP_STEADY_SP, // First temporal iteration, non-edge spatial iterations
+    FIRST_TP_EDGE_SP,
+    STEADY_TP_STEADY_SP,
+    STEADY_TP_EDGE_SP
+  };
+
+  // One phase of GetRunTime: count iterations of the same delay
+  class RuntimePhase {
+    public:
+      RuntimePhaseClass cls = RuntimePhaseClass::INITIAL_FILL;
+      std::string name;
+      bool is_steady_state = false;
+      long count = 0;
+
+      long noc_in_delay = 0;
+      long noc_out_delay = 0;
+      long compute_delay = 0;
+      long dram_delay = 0;
+      long iteration_delay = 0;
+      RuntimeResource bound = RuntimeResource::COMPUTE; // The component that set iteration_delay
+
+      long GetTotalDelay() const {
+        return CheckedMul(count, iteration_delay);
+      }
+  }; // End of class RuntimePhase
+
+  // Where the cycles of GetRunTime go
+  class RuntimeBreakdown {
+    public:
+      std::vector<RuntimePhase> phases;
+      long num_tp_foldings = 1;
+      long num_sp_foldings = 1;
+      bool latency_hiding = true;
+      int prefetch_depth = 2;
+      bool drain_overlap = false;
+
+      // The phase of class cls; nullptr if the runtime did not have it
+      const RuntimePhase* FindPhase(RuntimePhaseClass cls) const {
+        for(auto& phase : phases) {
+          if(phase.cls == cls) return &phase;
+        }
+        return nullptr;
+      }
+
+      long GetRuntime() const {
+        long runtime = 0;
+        for(auto& phase : phases) {
+          runtime = CheckedAdd(runtime, phase.GetTotalDelay());
+        }
+        return runtime;
+      }
+
+      // Cycles of the phases bound by resource; only the steady-state phases if steady_state_only
+      long GetBoundCycles(RuntimeResource resource, bool steady_state_only = false) const {
+        long cycles = 0;
+        for(auto& phase : phases) {
+          if(phase.bound == resource && (phase.is_steady_state || !steady_state_only)) {
+            cycles = CheckedAdd(cycles, phase.GetTotalDelay());
+          }
+        }
+        return cycles;
+      }
+
+      RuntimeResource GetBottleneck() const {
+        RuntimeResource bottleneck = RuntimeResource::COMPUTE;
+        long max_cycles = -1;
+        for(auto resource : {RuntimeResource::NOC_IN, RuntimeResource::NOC_OUT, RuntimeResource::COMPUTE, RuntimeResource::DRAM}) {
+          long cycles = this->GetBoundCycles(resource);
+          if(cycles > max_cycles) {
+            bottleneck = resource;
+            max_cycles = cycles;
+          }
+        }
+        return bottleneck;
+      }
+  }; // End of class RuntimeBreakdown
+
   class PerformanceAnalysis {
     protected:
       std::shared_ptr<MappingAnalysis> map_analysis_;
       std::shared_ptr<BufferAnalysis> buffer_analysis_;
       std::shared_ptr<NetworkOnChipModel> noc_model_;
+      std::shared_ptr<OffChipMemoryModel> dram_model_;
+      std::shared_ptr<SparsityModel> sparsity_model_;
       bool perform_reduction_;
       bool same_cycle_reduction_;
       bool fine_grained_sync_;
+      bool drain_overlap_;
+
+      /*
+       * Delay of the inputs of a fold. With prefetch_depth - 1 transfers in flight, the head delay
+       * of each transfer overlaps the previous ones; the serialization on the NoC does not.
+       */
+      static long GetInputDelay(NetworkOnChipModel& noc_model, long traffic, int prefetch_depth) {
+        long delay = noc_model.GetOutStandingDelay(traffic);
+        if(prefetch_depth <= 2) return delay;
+
+        long head_delay = noc_model.GetZeroLoadDelay();
+        long num_in_flight = prefetch_depth - 1;
+        return delay - head_delay + (head_delay + num_in_flight - 1) / num_in_flight;
+      }
+
+      // Inputs wait for the previous fold without a prefetch buffer, and outputs wait for the computation without drain overlap
+      static long GetIterationDelay(long L2ToL1_noc_delay, long L1ToL2_noc_delay, long compute_delay, long dram_delay, const RuntimeTerms& terms) {
+        long iteration_delay;
+
+        if(terms.latency_hiding) {
+          long pe_delay = terms.drain_overlap? compute_delay : CheckedAdd(L1ToL2_noc_delay, compute_delay);
+          if(terms.prefetch_depth <= 1) pe_delay = CheckedAdd(pe_delay, L2ToL1_noc_delay);
+
+          iteration_delay = std::max(terms.prefetch_depth <= 1? 0 : L2ToL1_noc_delay, pe_delay);
+          iteration_delay = std::max(iteration_delay, terms.drain_overlap? L1ToL2_noc_delay : 0);
+          iteration_delay = std::max(iteration_delay, dram_delay);
+        }
+        else {
+          iteration_delay = CheckedAdd(CheckedAdd(L2ToL1_noc_delay, compute_delay), CheckedAdd(L1ToL2_noc_delay, dram_delay));
+        }
+
+        return iteration_delay;
+      }
 
     public:
       PerformanceAnalysis(std::shared_ptr<MappingAnalysis> map_analysis, std::shared_ptr<BufferAnalysis> buffer_analysis,
@@ -223,160 +623,418 @@ class BufferAnalysis {
         map_analysis_(map_analysis),
         buffer_analysis_(buffer_analysis),
         noc_model_(noc_model),
+        dram_model_(nullptr),
+        sparsity_model_(nullptr),
         perform_reduction_(reduction),
         same_cycle_reduction_(same_cycle_reduction),
-        fine_grained_sync_(fg_sync)
+        fine_grained_sync_(fg_sync),
+        drain_overlap_(false)
       {
       }
 
-      long GetNumOpsPerPE (std::list<std::string> correlated_tensors, bool doCartesianProduct) {
+      void SetDrainOverlap(bool drain_overlap) {
+        drain_overlap_ = drain_overlap;
+      }
+
+      void SetOffChipMemoryModel(std::shared_ptr<OffChipMemoryModel> dram_model) {
+        dram_model_ = dram_model;
+      }
+
+      std::shared_ptr<OffChipMemoryModel> GetOffChipMemoryModel() {
+        return dram_model_;
+      }
+
+      void SetSparsityModel(std::shared_ptr<SparsityModel> sparsity_model) {
+        sparsity_model_ = sparsity_model;
+      }
+
+      std::shared_ptr<SparsityModel> GetSparsityModel() {
+        return sparsity_model_;
+      }
+
+      // Sliding windows are counted in window positions; a stride skips operations, it does not add any
+      long GetNumOpsPerPE (const std::list<std::string>& correlated_tensors, bool doCartesianProduct) {
         long num_ops = 1;
         long mult = 1;
         long small_one = 0;
 
         if(doCartesianProduct) {
           for(auto& tensor_name : correlated_tensors) {
-            num_ops *= static_cast<long>(map_analysis_->GetMappedSize(tensor_name, false, false));
+            num_ops = CheckedMul(num_ops, map_analysis_->GetMappedSize(tensor_name, false, false, false));
           }
         }
         else {
           for(auto& tensor_name : correlated_tensors) {
-            long map_size = static_cast<long>(map_analysis_->GetMappedSize(tensor_name, false, false));
+            long map_size = static_cast<long>(map_analysis_->GetMappedSize(tensor_name, false, false, false));
             if(map_size > num_ops) {
               mult = num_ops;
               num_ops = map_size;
             }
             else {
               //TODO: Extend it. It is not correct for arbitrary applications;
-              mult *= map_size;
+              mult = CheckedMul(mult, map_size);
             }
           }
         }
 
         if(perform_reduction_ && !same_cycle_reduction_) {
-          num_ops = 2 * num_ops * mult - 1;
+          num_ops = CheckedMul(2, CheckedMul(num_ops, mult)) - 1;
         }
 
         return num_ops;
       }
 
-      long GetRunTime (std::list<std::string> input_tensors, std::list<std::string> output_tensors, int num_pes, int num_alus_per_pe, bool latency_hiding) {
-
-        long runtime = 0;
+      /*
+       * Operations on each PE in an iteration. Declared operators count every point of the mapped iteration space;
+       * the implicit convolution keeps the estimate from its input tensor sizes.
+       */
+      long GetNumOpsPerPE () {
+        auto operator_info = map_analysis_->GetOperator();
+        if(!operator_info->IsDeclared()) {
+          return this->GetNumOpsPerPE(operator_info->GetInputTensors(), false);
+        }
 
-        int num_tp_foldings = map_analysis_->GetNumTemporalIterations();
-        int num_sp_foldings = map_analysis_->GetNumSpatialFoldings();
-        int num_sp_edge_tiles = map_analysis_->GetNumEdgeTiles();
+        long num_ops = map_analysis_->GetMappedIterations();
 
-        long compute_delay = this->GetNumOpsPerPE(input_tensors, false)/num_alus_per_pe;
-        if(compute_delay == 0) compute_delay = 1;
+        bool has_reduction = !operator_info->GetReductionVariables().empty();
+        if(perform_reduction_ && has_reduction && !same_cycle_reduction_) {
+          num_ops = CheckedMul(2, num_ops) - 1;
+        }
 
-        if(!fine_grained_sync_) {
+        return num_ops;
+      }
 
+      /*
+       * Operations of the slowest PE when operations with a zero operand are skipped.
+       * Zeros are not spread evenly, so the PEs of a spatial iteration wait for the busiest one.
+       */
+      long GetEffectualNumOpsPerPE (int num_pes) {
+        long num_ops = this->GetNumOpsPerPE();
+        if(sparsity_model_ == nullptr) return num_ops;
 
-          long init_traffic_amount = 0;
-          for(auto& in_tensor_name : input_tensors) {
-            init_traffic_amount += buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, true, false);
-          }
+        return sparsity_model_->GetMaxEffectualOps(num_ops, map_analysis_->GetOperator()->GetInputTensors(), num_pes);
+      }
 
-          long init_noc_delay = noc_model_->GetOutStandingDelay(init_traffic_amount);
+      /*
+       * Mapping-derived quantities of GetRunTime. Once they are extracted, the runtime only depends on
+       * the NoC (bandwidth, hops, hop latency) and the number of ALUs per PE.
+       */
+      RuntimeTerms GetRunTimeTerms (const std::list<std::string>& input_tensors, const std::list<std::string>& output_tensors, int num_pes, bool latency_hiding) {
+        RuntimeTerms terms;
+
+        terms.fine_grained_sync = fine_grained_sync_;
+        terms.latency_hiding = latency_hiding;
+        terms.prefetch_depth = buffer_analysis_->GetPrefetchDepth();
+        terms.drain_overlap = drain_overlap_;
+        terms.num_tp_foldings = map_analysis_->GetNumTemporalIterations();
+        terms.num_sp_foldings = map_analysis_->GetNumSpatialFoldings();
+        terms.num_ops_per_pe = this->GetEffectualNumOpsPerPE(num_pes);
+
+        if(fine_grained_sync_) {
+          //TODO: Add fine-grained sync case
+          return terms;
+        }
 
-          runtime+=init_noc_delay;
+        for(auto& in_tensor_name : input_tensors) {
+          terms.init_traffic = CheckedAdd(terms.init_traffic, buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, true, false));
+        }
 
-          long L2ToL1_traffic = 0;
-          long L1ToL2_traffic = 0;
+        /* DRAM traffic is streamed behind the on-chip iterations; only the first fill exposes the access latency */
+        if(dram_model_ != nullptr) {
+          long dram_traffic = buffer_analysis_->GetDRAMTraffic(input_tensors, output_tensors);
+          long num_iterations = CheckedMul(terms.num_tp_foldings, terms.num_sp_foldings);
+          long dram_traffic_per_iteration = dram_traffic / num_iterations;
+          if(dram_traffic % num_iterations != 0) dram_traffic_per_iteration++;
 
-          long L2ToL1_noc_delay = 0;
-          long L1ToL2_noc_delay  = 0;
+          terms.dram_delay = dram_model_->GetStreamingDelay(dram_traffic_per_iteration);
+          terms.init_dram_delay = dram_model_->GetOutStandingDelay(terms.init_traffic);
+        }
 
-          for(auto& out_tensor_name : output_tensors) {
-            L1ToL2_traffic += buffer_analysis_->GetSpatialL1ToL2Traffic(out_tensor_name);
-          }
-          L1ToL2_noc_delay = noc_model_->GetOutStandingDelay(L1ToL2_traffic);
-
-          long this_iteration_delay = 0;
-
-          /* Analytic model */
-          {
-            /* 1. Temp iter = 0 */
-            // 1-1) Non-edge spatial iterations (steady state)
-            if(num_sp_foldings > 2 ) {
-              for(auto& in_tensor_name : input_tensors) {
-                long tp_change_freq = map_analysis_->GetTemporalChangeFrequency(in_tensor_name);
-                L2ToL1_traffic += buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, false, false)/tp_change_freq; // tp_iter =0, sp iter is in steady state
-              }
-              L2ToL1_noc_delay = noc_model_->GetOutStandingDelay(L2ToL1_traffic);
-              if(latency_hiding) {
-                this_iteration_delay = std::max(L2ToL1_noc_delay, L1ToL2_noc_delay + compute_delay);
-              }
-              else {
-                this_iteration_delay = L2ToL1_noc_delay + compute_delay + L1ToL2_noc_delay;
-              }
-              runtime += (num_sp_foldings -2) * this_iteration_delay;
-            }
-            // 1-2) At spatial iteration edge
-            L2ToL1_traffic = 0;
-            for(auto& in_tensor_name : input_tensors) {
-              long tp_change_freq = map_analysis_->GetTemporalChangeFrequency(in_tensor_name);
-              L2ToL1_traffic += buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, false, true)/tp_change_freq; // tp_iter =0, sp iter is in steady state
+        for(auto& out_tensor_name : output_tensors) {
+          terms.L1ToL2_traffic = CheckedAdd(terms.L1ToL2_traffic, buffer_analysis_->GetSpatialL1ToL2Traffic(out_tensor_name));
+          terms.reduction_delay = CheckedAdd(terms.reduction_delay, buffer_analysis_->GetReductionDelay(out_tensor_name));
+        }
 
-            }
-            L2ToL1_noc_delay = noc_model_->GetOutStandingDelay(L2ToL1_traffic);
+        /* 1. Temp iter = 0 */
+        // 1-1) Non-edge spatial iterations (steady state)
+        for(auto& in_tensor_name : input_tensors) {
+          long tp_change_freq = map_analysis_->GetTemporalChangeFrequency(in_tensor_name);
+          terms.first_tp_steady_sp_traffic = CheckedAdd(terms.first_tp_steady_sp_traffic, buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, false, false)/tp_change_freq); // tp_iter =0, sp iter is in steady state
+        }
 
-            if(latency_hiding) {
-              this_iteration_delay = std::max(L2ToL1_noc_delay, L1ToL2_noc_delay + compute_delay);
-            }
-            else {
-              this_iteration_delay = L2ToL1_noc_delay + compute_delay + L1ToL2_noc_delay;
-            }
+        // 1-2) At spatial iteration edge
+        for(auto& in_tensor_name : input_tensors) {
+          long tp_change_freq = map_analysis_->GetTemporalChangeFrequency(in_tensor_name);
+          terms.first_tp_edge_sp_traffic = CheckedAdd(terms.first_tp_edge_sp_traffic, buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, true, false, true)/tp_change_freq); // tp_iter =0, sp iter is in steady state
+        }
 
-            runtime += this_iteration_delay;
+        /* 2. Temp iter != 0 */
+        // 2-1) Non-edge spatial iterations (steady state); accumulates on top of the traffic of 1-2
+        terms.steady_tp_steady_sp_traffic = terms.first_tp_edge_sp_traffic;
+        for(auto& in_tensor_name : input_tensors) {
+          long tp_change_freq = static_cast<long> (map_analysis_->GetTemporalChangeFrequency(in_tensor_name));
+          terms.steady_tp_steady_sp_traffic = CheckedAdd(terms.steady_tp_steady_sp_traffic, buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, false, false, false)/tp_change_freq); // tp_iter and sp_iter are in steady states
+        }
 
-            /* 2. Temp iter != 0 */
-            // 2-1) Non-edge spatial iterations (steady state)
-            for(auto& in_tensor_name : input_tensors) {
-              long tp_change_freq = static_cast<long> (map_analysis_->GetTemporalChangeFrequency(in_tensor_name));
-              L2ToL1_traffic += buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, false, false, false)/tp_change_freq; // tp_iter and sp_iter are in steady states
-            }
-            L2ToL1_noc_delay = noc_model_->GetOutStandingDelay(L2ToL1_traffic);
+        // 2-2) At spatial iteration edge
+        for(auto& in_tensor_name : input_tensors) {
+          long tp_change_freq = static_cast<long> (map_analysis_->GetTemporalChangeFrequency(in_tensor_name));
+          terms.steady_tp_edge_sp_traffic = CheckedAdd(terms.steady_tp_edge_sp_traffic, buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, false, false, true)/tp_change_freq); // tp_iter is in steady states (does not distinguish edge), sp_iter is at edge
+        }
 
-            if(latency_hiding) {
-              this_iteration_delay = std::max(L2ToL1_noc_delay, L1ToL2_noc_delay + compute_delay);
+        return terms;
+      } // End of GetRunTimeTerms
+
+      // Records an iteration phase of GetRunTime and the component that set its delay
+      static void AddPhase(RuntimeBreakdown* breakdown, RuntimePhaseClass cls, std::string name, bool is_steady_state, long count,
+                           long L2ToL1_noc_delay, long L1ToL2_noc_delay, long compute_delay, long dram_delay, const RuntimeTerms& terms) {
+        if(breakdown == nullptr) return;
+
+        RuntimePhase phase;
+        phase.cls = cls;
+        phase.name = name;
+        phase.is_steady_state = is_steady_state;
+        phase.count = count;
+        phase.noc_in_delay = L2ToL1_noc_delay;
+        phase.noc_out_delay = L1ToL2_noc_delay;
+        phase.compute_delay = compute_delay;
+        phase.dram_delay = dram_delay;
+        phase.iteration_delay = GetIterationDelay(L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, dram_delay, terms);
+
+        if(terms.latency_hiding) {
+          // The delays that take turns with the computation are charged together, and the longest of them is the bound
+          long serial_in_delay = (terms.prefetch_depth <= 1)? L2ToL1_noc_delay : 0;
+          long serial_out_delay = terms.drain_overlap? 0 : L1ToL2_noc_delay;
+          long pe_delay = serial_in_delay + compute_delay + serial_out_delay;
+          long in_delay = (terms.prefetch_depth <= 1)? 0 : L2ToL1_noc_delay;
+          long out_delay = terms.drain_overlap? L1ToL2_noc_delay : 0;
+
+          if(in_delay >= pe_delay && in_delay >= out_delay && in_delay >= dram_delay) {
+            phase.bound = RuntimeResource::NOC_IN;
+          }
+          else if(pe_delay >= out_delay && pe_delay >= dram_delay) {
+            if(compute_delay >= serial_out_delay && compute_delay >= serial_in_delay) {
+              phase.bound = RuntimeResource::COMPUTE;
             }
             else {
-              this_iteration_delay = L2ToL1_noc_delay + compute_delay + L1ToL2_noc_delay;
+              phase.bound = (serial_out_delay >= serial_in_delay)? RuntimeResource::NOC_OUT : RuntimeResource::NOC_IN;
             }
+          }
+          else if(out_delay >= dram_delay) {
+            phase.bound = RuntimeResource::NOC_OUT;
+          }
+          else {
+            phase.bound = RuntimeResource::DRAM;
+          }
+        }
+        else {
+          long max_delay = std::max(std::max(L2ToL1_noc_delay, L1ToL2_noc_delay), std::max(compute_delay, dram_delay));
+          phase.bound = (max_delay == L2ToL1_noc_delay)? RuntimeResource::NOC_IN
+                      : (max_delay == compute_delay)? RuntimeResource::COMPUTE
+                      : (max_delay == L1ToL2_noc_delay)? RuntimeResource::NOC_OUT : RuntimeResource::DRAM;
+        }
 
-            runtime += (num_tp_foldings-1) * (num_sp_foldings -1) * this_iteration_delay;
-
-            // 2-2) At spatial iteration edge
-            L2ToL1_traffic = 0;
-            for(auto& in_tensor_name : input_tensors) {
-              long tp_change_freq = static_cast<long> (map_analysis_->GetTemporalChangeFrequency(in_tensor_name));
-              L2ToL1_traffic += buffer_analysis_->GetSpatialL2ToL1Traffic(in_tensor_name, num_pes, false, false, true)/tp_change_freq; // tp_iter is in steady states (does not distinguish edge), sp_iter is at edge
-            }
-            L2ToL1_noc_delay = noc_model_->GetOutStandingDelay(L2ToL1_traffic);
+        breakdown->phases.push_back(phase);
+      }
 
-            if(latency_hiding) {
-              this_iteration_delay = std::max(L2ToL1_noc_delay, L1ToL2_noc_delay + compute_delay);
-            }
-            else {
-              this_iteration_delay = L2ToL1_noc_delay + compute_delay + L1ToL2_noc_delay;
-            }
+      // If breakdown is given, it receives the delay components and the bound of every phase
+      static long GetRunTime (const RuntimeTerms& terms, NetworkOnChipModel& noc_model, int num_alus_per_pe, RuntimeBreakdown* breakdown = nullptr) {
+        long runtime = 0;
 
-            runtime += (num_tp_foldings-1) * this_iteration_delay;
-          }
-        } // End of if (!fine_grained_sync_)
-        else {
+        if(terms.fine_grained_sync) {
           //TODO: Add fine-grained sync case
+          return runtime;
+        }
 
+        long compute_delay = terms.num_ops_per_pe/num_alus_per_pe;
+        if(compute_delay == 0) compute_delay = 1;
 
+        long init_noc_delay = noc_model.GetOutStandingDelay(terms.init_traffic);
+        runtime = CheckedAdd(runtime, init_noc_delay);
+        runtime = CheckedAdd(runtime, terms.init_dram_delay);
+        if(breakdown != nullptr) {
+          breakdown->num_tp_foldings = terms.num_tp_foldings;
+          breakdown->num_sp_foldings = terms.num_sp_foldings;
+          breakdown->latency_hiding = terms.latency_hiding;
+          breakdown->prefetch_depth = terms.prefetch_depth;
+          breakdown->drain_overlap = terms.drain_overlap;
+
+          RuntimePhase init_phase;
+          init_phase.name = "Initial fill";
+          init_phase.count = 1;
+          init_phase.noc_in_delay = init_noc_delay;
+          init_phase.dram_delay = terms.init_dram_delay;
+          init_phase.iteration_delay = CheckedAdd(init_noc_delay, terms.init_dram_delay);
+          init_phase.bound = (init_noc_delay >= terms.init_dram_delay)? RuntimeResource::NOC_IN : RuntimeResource::DRAM;
+          breakdown->phases.push_back(init_phase);
+        }
+
+        long L1ToL2_noc_delay = CheckedAdd(terms.reduction_delay, noc_model.GetOutStandingDelay(terms.L1ToL2_traffic));
+        long L2ToL1_noc_delay = 0;
+        long this_iteration_delay = 0;
+
+        /* Analytic model */
+        {
+          /* 1. Temp iter = 0 */
+          // 1-1) Non-edge spatial iterations (steady state)
+          if(terms.num_sp_foldings > 2 ) {
+            L2ToL1_noc_delay = GetInputDelay(noc_model, terms.first_tp_steady_sp_traffic, terms.prefetch_depth);
+            this_iteration_delay = GetIterationDelay(L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+            runtime = CheckedAdd(runtime, CheckedMul(terms.num_sp_foldings -2, this_iteration_delay));
+            AddPhase(breakdown, RuntimePhaseClass::FIRST_TP_STEADY_SP, "First temporal iteration, steady spatial iterations", false, terms.num_sp_foldings -2,
+                     L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+          }
+
+          // 1-2) At spatial iteration edge
+          L2ToL1_noc_delay = GetInputDelay(noc_model, terms.first_tp_edge_sp_traffic, terms.prefetch_depth);
+          this_iteration_delay = GetIterationDelay(L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+          runtime = CheckedAdd(runtime, this_iteration_delay);
+          AddPhase(breakdown, RuntimePhaseClass::FIRST_TP_EDGE_SP, "First temporal iteration, edge spatial iteration", false, 1,
+                   L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+
+          /* 2. Temp iter != 0 */
+          // 2-1) Non-edge spatial iterations (steady state)
+          L2ToL1_noc_delay = GetInputDelay(noc_model, terms.steady_tp_steady_sp_traffic, terms.prefetch_depth);
+          this_iteration_delay = GetIterationDelay(L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+          runtime = CheckedAdd(runtime, CheckedMul(CheckedMul(terms.num_tp_foldings-1, terms.num_sp_foldings -1), this_iteration_delay));
+          AddPhase(breakdown, RuntimePhaseClass::STEADY_TP_STEADY_SP, "Steady temporal iterations, steady spatial iterations", true, CheckedMul(terms.num_tp_foldings-1, terms.num_sp_foldings -1),
+                   L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+
+          // 2-2) At spatial iteration edge
+          L2ToL1_noc_delay = GetInputDelay(noc_model, terms.steady_tp_edge_sp_traffic, terms.prefetch_depth);
+          this_iteration_delay = GetIterationDelay(L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
+          runtime = CheckedAdd(runtime, CheckedMul(terms.num_tp_foldings-1, this_iteration_delay));
+          AddPhase(breakdown, RuntimePhaseClass::STEADY_TP_EDGE_SP, "Steady temporal iterations, edge spatial iteration", false, terms.num_tp_foldings-1,
+                   L2ToL1_noc_delay, L1ToL2_noc_delay, compute_delay, terms.dram_delay, terms);
         }
 
         return runtime;
+      }
+
+      long GetRunTime (const std::list<std::string>& input_tensors, const std::list<std::string>& output_tensors, int num_pes, int num_alus_per_pe, bool latency_hiding,
+                       RuntimeBreakdown* breakdown = nullptr) {
+        auto terms = this->GetRunTimeTerms(input_tensors, output_tensors, num_pes, latency_hiding);
+
+        return GetRunTime(terms, *noc_model_, num_alus_per_pe, breakdown);
       } // End of GetRunTime
+  }; // End of class PerformanceAnalysis
+
+  enum class RooflineBound {
+    COMPUTE,
+    NOC,
+    DRAM
   };
 
+  /*
+   * Places a layer on a three-level roofline (PE array, NoC, DRAM).
+   * Each bound is the runtime the layer would have if only that resource limited it. The roofs
+   * are those of LowerBoundAnalysis; the NoC and DRAM bounds apply them to the traffic of the
+   * mapping instead of the compulsory traffic.
+   */
+  class RooflineAnalysis {
+    protected:
+      std::shared_ptr<MappingAnalysis> map_analysis_;
+      std::shared_ptr<BufferAnalysis> buffer_analysis_;
+      std::shared_ptr<NetworkOnChipModel> noc_model_;
+      std::shared_ptr<OffChipMemoryModel> dram_model_;
+
+      std::list<std::string> input_tensors_;
+      std::list<std::string> output_tensors_;
+
+      long num_pes_;
+      long num_alus_per_pe_;
+
+      LowerBoundAnalysis roofs_;
+
+    public:
+      RooflineAnalysis(std::shared_ptr<MappingAnalysis> map_analysis, std::shared_ptr<BufferAnalysis> buffer_analysis,
+                       std::shared_ptr<NetworkOnChipModel> noc_model, std::shared_ptr<OffChipMemoryModel> dram_model,
+                       std::list<std::string> input_tensors, std::list<std::string> output_tensors,
+                       long num_pes, long num_alus_per_pe) :
+        map_analysis_(map_analysis),
+        buffer_analysis_(buffer_analysis),
+        noc_model_(noc_model),
+        dram_model_(dram_model),
+        input_tensors_(input_tensors),
+        output_tensors_(output_tensors),
+        num_pes_(num_pes),
+        num_alus_per_pe_(num_alus_per_pe),
+        roofs_(map_analysis->GetLoopInfoTable(), noc_model, dram_model, buffer_analysis->GetSparsityModel(), num_pes, num_alus_per_pe)
+      {
+      }
+
+      // Operations left after skipping the ones with a zero operand
+      long GetEffectualTotalOps() {
+        return roofs_.GetEffectualTotalOps();
+      }
+
+      long GetComputeBoundDelay() {
+        return roofs_.GetComputeBoundDelay();
+      }
+
+      long GetNoCBoundDelay() {
+        long L2ToL1_traffic = 0;
+        for(auto& in_tensor_name : input_tensors_) {
+          L2ToL1_traffic = CheckedAdd(L2ToL1_traffic, buffer_analysis_->GetL2BufferRead(in_tensor_name));
+        }
+
+        long L1ToL2_traffic = 0;
+        for(auto& out_tensor_name : output_tensors_) {
+          L1ToL2_traffic = CheckedAdd(L1ToL2_traffic, buffer_analysis_->GetL1ToL2Traffic(out_tensor_name));
+        }
+
+        return roofs_.GetNoCDelay(L2ToL1_traffic, L1ToL2_traffic);
+      }
+
+      long GetDRAMTraffic() {
+        return buffer_analysis_->GetDRAMTraffic(input_tensors_, output_tensors_);
+      }
+
+      long GetDRAMBoundDelay() {
+        return roofs_.GetDRAMDelay(this->GetDRAMTraffic());
+      }
+
+      // Operations per element moved from/to DRAM; unbounded if nothing is (e.g., an unbounded L2 or a fused layer)
+      double GetOperationalIntensity() {
+        long ops = this->GetEffectualTotalOps();
+        long traffic = this->GetDRAMTraffic();
+        if(traffic <= 0) {
+          return (ops > 0)? std::numeric_limits<double>::infinity() : 0.0;
+        }
+
+        return static_cast<double>(ops) / static_cast<double>(traffic);
+      }
+
+      // Operational intensity where the DRAM roof meets the compute roof
+      double GetRidgePoint() {
+        if(dram_model_ == nullptr) return 0.0;
+
+        return static_cast<double>(num_pes_ * num_alus_per_pe_) / static_cast<double>(dram_model_->GetBandwidth());
+      }
+
+      RooflineBound GetBound() {
+        switch(LowerBoundAnalysis::GetBindingResource(this->GetComputeBoundDelay(), this->GetNoCBoundDelay(), this->GetDRAMBoundDelay())) {
+          case LowerBoundResource::DRAM:
+            return RooflineBound::DRAM;
+          case LowerBoundResource::NOC:
+            return RooflineBound::NOC;
+          default:
+            return RooflineBound::COMPUTE;
+        }
+      }
+
+      std::string GetBoundName() {
+        switch(this->GetBound()) {
+          case RooflineBound::DRAM:
+            return "DRAM";
+          case RooflineBound::NOC:
+            return "NoC";
+          default:
+            return "Compute";
+        }
+      }
+  }; // End of class RooflineAnalysis
+
 
 };
 
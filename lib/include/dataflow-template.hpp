@@ -0,0 +1,166 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_DATAFLOW_TEMPLATE_HPP_
+#define MAESTRO_DATAFLOW_TEMPLATE_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "mapping-syntax.hpp"
+#include "analysis-structure.hpp"
+
+namespace maestro {
+
+  enum class SizeTermClass {
+    CONSTANT,
+    PARAMETER, // A name bound at evaluation time, e.g., Tk
+    LOOP_SIZE  // Sz(R): the loop bound of a variable of the layer
+  };
+
+  class SizeExpression {
+    public:
+      SizeTermClass cls = SizeTermClass::CONSTANT;
+      int value = 1;
+      std::string name;
+
+      std::string ToString() const {
+        switch(cls) {
+          case SizeTermClass::PARAMETER: return name;
+          case SizeTermClass::LOOP_SIZE: return tkn_loop_size + "(" + name + ")";
+          default: return std::to_string(value);
+        }
+      }
+  }; // End of class SizeExpression
+
+  // A size or offset of a directive that is only known once the template is bound
+  class TemplateSite {
+    public:
+      int pragma_pos = 0;
+      bool is_offset = false;
+      SizeExpression expression;
+  }; // End of class TemplateSite
+
+  /*
+   * A dataflow whose sizes may be symbolic, e.g., "Temporal_Map (Tk,Tk) K", "Cluster (Cx) X",
+   * or "Temporal_Map (Sz(R),1) Y". It is parsed once; Bind() produces the concrete pragma table
+   * of one binding by copying the value entries of the template, so no directive is reparsed
+   * or reallocated.
+   */
+  class DataflowTemplate {
+    protected:
+      std::shared_ptr<PragmaTable> pragma_table_; // Symbolic sizes hold 1
+      std::vector<TemplateSite> sites_;
+
+    public:
+      DataflowTemplate(std::shared_ptr<PragmaTable> prag_tbl, std::vector<TemplateSite> sites) :
+        pragma_table_(prag_tbl),
+        sites_(sites)
+      {
+      }
+
+      bool IsSymbolic() const {
+        return !sites_.empty();
+      }
+
+      // Names that Bind() needs values for, in the order of their first use
+      std::vector<std::string> GetParameters() const {
+        std::vector<std::string> params;
+        for(auto& site : sites_) {
+          if(site.expression.cls == SizeTermClass::PARAMETER
+             && std::find(params.begin(), params.end(), site.expression.name) == params.end()) {
+            params.push_back(site.expression.name);
+          }
+        }
+        return params;
+      }
+
+      // The directives as parsed; symbolic sizes hold 1
+      std::shared_ptr<PragmaTable> GetPragmaTable() const {
+        return pragma_table_;
+      }
+
+      /*
+       * Throws std::runtime_error if a parameter has no positive value in params.
+       * Sz() of a variable that the layer does not have is 1.
+       */
+      std::shared_ptr<PragmaTable> Bind(const std::map<std::string, int>& params, std::shared_ptr<LoopInfoTable> loop_tbl) const {
+        if(sites_.empty()) return pragma_table_;
+
+        auto entries = pragma_table_->GetEntries();
+        for(auto& site : sites_) {
+          int value = site.expression.value;
+
+          if(site.expression.cls == SizeTermClass::PARAMETER) {
+            auto param = params.find(site.expression.name);
+            if(param == params.end()) {
+              throw std::runtime_error("the dataflow parameter " + site.expression.name + " is not bound");
+            }
+            value = param->second;
+          }
+          else if(site.expression.cls == SizeTermClass::LOOP_SIZE) {
+            auto loop = (loop_tbl != nullptr)? loop_tbl->FindLoop(site.expression.name) : nullptr;
+            value = (loop != nullptr)? loop->GetNumIter() : 1;
+          }
+
+          if(value <= 0) {
+            throw std::runtime_error("the dataflow size " + site.expression.ToString() + " must be positive");
+          }
+
+          auto& entry = entries[site.pragma_pos];
+          if(site.is_offset) {
+            entry.offset = value;
+          }
+          else {
+            entry.size = value;
+          }
+        }
+
+        return pragma_table_->WithEntries(std::move(entries));
+      }
+  }; // End of class DataflowTemplate
+
+  // Bindings from "name=value" assignments; throws std::runtime_error on a malformed assignment
+  inline std::map<std::string, int> ParseTemplateBindings(const std::vector<std::string>& assignments) {
+    std::map<std::string, int> params;
+    for(auto& assignment : assignments) {
+      auto separator = assignment.find('=');
+      std::size_t length = 0;
+      int value = 0;
+      try {
+        value = std::stoi(assignment.substr(separator + 1), &length);
+      }
+      catch(std::exception& e) {
+        length = 0;
+      }
+      if(separator == std::string::npos || separator == 0 || length == 0 || separator + 1 + length != assignment.size()) {
+        throw std::runtime_error("expected a dataflow parameter as name=value, got " + assignment);
+      }
+      params[assignment.substr(0, separator)] = value;
+    }
+    return params;
+  }
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,647 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_DESIGN_SPACE_SWEEP_HPP_
+#define MAESTRO_DESIGN_SPACE_SWEEP_HPP_
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <map>
+#include <limits>
+
+#include "option.hpp"
+#include "analysis-structure.hpp"
+#include "dataflow-template.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "layer-analysis.hpp"
+#include "mapping-canonicalization.hpp"
+#include "lower-bound-analysis.hpp"
+#include "evaluation-arena.hpp"
+#include "sweep-spec.hpp"
+
+namespace maestro {
+
+  // Hardware options that a sweep can vary, in the order of SweepPoint::parameters
+  const std::vector<std::string> sweep_hardware_parameters = {"num_pes", "num_pe_alus", "noc_bw", "noc_hops", "noc_hop_latency",
+                                                              "noc_mc_support", "l2_size", "dram_bw", "dram_latency",
+                                                              "prefetch_depth", "drain_overlap"};
+
+  // Metrics that constraints can refer to
+  const std::vector<std::string> sweep_metrics = {"runtime", "energy", "l1_buffer_requirement", "l2_buffer_requirement",
+                                                  "dram_traffic", "runtime_per_sample", "energy_per_sample",
+                                                  "pe_utilization", "noc_utilization"};
+
+  class SweepPoint {
+    public:
+      long point_id = -1;
+      std::vector<long> values;     // Per dimension of the sweep
+      std::vector<long> parameters; // Per sweep_hardware_parameters, including the ones not swept
+      LayerMetrics metrics;
+  }; // End of class SweepPoint
+
+  class SweepSummary {
+    public:
+      long num_points = 0;
+      long num_pruned = 0;   // Rejected by constraints on parameters, before the analysis
+      long num_invalid = 0;  // Too few PEs, non-positive sizes, or overflows
+      long num_rejected = 0; // Rejected by constraints on metrics
+      long num_accepted = 0;
+      long num_reused = 0;   // Equivalent to a mapping analyzed before, so not analyzed again
+      long num_bounded = 0;  // Among num_rejected; no mapping meets the runtime constraints on their hardware
+
+      bool has_best = false;
+      SweepPoint best_runtime;
+      SweepPoint best_energy;
+
+      void Merge(const SweepSummary& other) {
+        num_points += other.num_points;
+        num_pruned += other.num_pruned;
+        num_invalid += other.num_invalid;
+        num_rejected += other.num_rejected;
+        num_accepted += other.num_accepted;
+        num_reused += other.num_reused;
+        num_bounded += other.num_bounded;
+
+        if(other.has_best) {
+          this->UpdateBest(other.best_runtime);
+          this->UpdateBest(other.best_energy);
+        }
+      }
+
+      // Ties go to the smaller point number, so the result does not depend on the thread schedule
+      void UpdateBest(const SweepPoint& point) {
+        if(!has_best || point.metrics.runtime < best_runtime.metrics.runtime
+           || (point.metrics.runtime == best_runtime.metrics.runtime && point.point_id < best_runtime.point_id)) {
+          best_runtime = point;
+        }
+        if(!has_best || point.metrics.energy < best_energy.metrics.energy
+           || (point.metrics.energy == best_energy.metrics.energy && point.point_id < best_energy.point_id)) {
+          best_energy = point;
+        }
+        has_best = true;
+      }
+  }; // End of class SweepSummary
+
+  /*
+   * Evaluates every point of a sweep specification on one layer. Points are generated from their
+   * numbers and handed to worker threads in chunks, so the space is never materialized.
+   * Parameters that are not swept keep the values of the command line options.
+   */
+  class DesignSpaceSweep {
+    protected:
+      enum class OperandClass {
+        CONSTANT,
+        PARAMETER,
+        MAP_SIZE,
+        DATAFLOW_PARAMETER,
+        METRIC
+      };
+
+      class Operand {
+        public:
+          OperandClass cls = OperandClass::CONSTANT;
+          int id = 0;
+          double constant = 0;
+      }; // End of class Operand
+
+      class ResolvedConstraint {
+        public:
+          Operand lhs;
+          ComparisonOp op;
+          Operand rhs;
+
+          bool UsesMetrics() const {
+            return lhs.cls == OperandClass::METRIC || rhs.cls == OperandClass::METRIC;
+          }
+      }; // End of class ResolvedConstraint
+
+      std::shared_ptr<SweepSpec> spec_;
+      std::shared_ptr<DataflowTemplate> dataflow_template_;
+      std::map<std::string, int> default_bindings_;
+      std::shared_ptr<PragmaTable> pragma_table_; // The template under the default bindings
+      std::shared_ptr<LoopInfoTable> loop_info_table_;
+
+      std::vector<long> default_parameters_;
+      SparseFormat sparse_format_;
+      std::shared_ptr<ReductionNetworkModel> reduction_model_; // nullptr: L2 accumulates partial sums
+      bool do_reduction_;
+      bool do_implicit_reduction_;
+      bool fg_sync_;
+
+      std::vector<int> parameter_ids_;  // Per dimension; -1 for map sizes
+      std::vector<int> pragma_positions_; // Per dimension; -1 unless a map size
+      bool binds_template_ = false;
+
+      // Results by canonical mapping and hardware parameters, when points differ in their dataflow
+      bool reuses_mappings_ = false;
+      bool has_runtime_caps_ = false; // Whether a constraint caps the runtime, so the lower bound can reject points
+      static constexpr std::size_t max_analyzed_mappings_ = 1 << 20;
+      std::map<std::string, LayerMetrics> analyzed_mappings_;
+      std::mutex analyzed_mappings_mutex_;
+      std::vector<ResolvedConstraint> constraints_;
+
+      static int FindName(const std::vector<std::string>& names, const std::string& name) {
+        auto it = std::find(names.begin(), names.end(), name);
+        return (it == names.end())? -1 : static_cast<int>(it - names.begin());
+      }
+
+      Operand ResolveOperand(const std::string& name) {
+        Operand operand;
+
+        char* end = nullptr;
+        operand.constant = std::strtod(name.c_str(), &end);
+        if(end != name.c_str() && *end == '\0') {
+          return operand;
+        }
+
+        auto& dimensions = spec_->GetDimensions();
+        for(int dim_id = 0; dim_id < static_cast<int>(dimensions.size()); dim_id++) {
+          auto target = dimensions[dim_id].GetTarget();
+          if(target != SweepTarget::HARDWARE && dimensions[dim_id].GetName() == name) {
+            operand.cls = (target == SweepTarget::MAP_SIZE)? OperandClass::MAP_SIZE : OperandClass::DATAFLOW_PARAMETER;
+            operand.id = dim_id;
+            return operand;
+          }
+        }
+
+        operand.id = FindName(sweep_hardware_parameters, name);
+        if(operand.id >= 0) {
+          operand.cls = OperandClass::PARAMETER;
+          return operand;
+        }
+
+        operand.id = FindName(sweep_metrics, name);
+        if(operand.id >= 0) {
+          operand.cls = OperandClass::METRIC;
+          return operand;
+        }
+
+        throw std::runtime_error("unknown parameter or metric in a constraint: " + name);
+      }
+
+      static double GetMetric(const LayerMetrics& metrics, int metric_id) {
+        switch(metric_id) {
+          case 0: return metrics.runtime;
+          case 1: return metrics.energy;
+          case 2: return metrics.l1_buffer_requirement;
+          case 3: return metrics.l2_buffer_requirement;
+          case 4: return metrics.dram_traffic;
+          case 5: return metrics.runtime_per_sample;
+          case 6: return metrics.energy_per_sample;
+          case 7: return metrics.pe_utilization;
+          default: return metrics.noc_utilization;
+        }
+      }
+
+      double GetOperandValue(const Operand& operand, const SweepPoint& point) {
+        switch(operand.cls) {
+          case OperandClass::CONSTANT: return operand.constant;
+          case OperandClass::PARAMETER: return point.parameters[operand.id];
+          case OperandClass::MAP_SIZE:
+          case OperandClass::DATAFLOW_PARAMETER: return point.values[operand.id];
+          default: return GetMetric(point.metrics, operand.id);
+        }
+      }
+
+      bool SatisfiesConstraints(const SweepPoint& point, bool on_metrics) {
+        for(auto& constraint : constraints_) {
+          if(constraint.UsesMetrics() != on_metrics) continue;
+
+          if(!SweepConstraint::Compare(this->GetOperandValue(constraint.lhs, point), constraint.op,
+                                       this->GetOperandValue(constraint.rhs, point))) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /*
+       * The dataflow with the swept template parameters and map sizes; maps whose offset equals
+       * their size keep doing so. Throws std::runtime_error if a value is not a positive int.
+       */
+      std::shared_ptr<PragmaTable> CreatePragmaTable(const std::vector<long>& values) {
+        auto pragma_table = pragma_table_;
+        auto& dimensions = spec_->GetDimensions();
+
+        if(binds_template_) {
+          auto bindings = default_bindings_;
+          for(int dim_id = 0; dim_id < static_cast<int>(values.size()); dim_id++) {
+            if(dimensions[dim_id].GetTarget() != SweepTarget::DATAFLOW_PARAMETER) continue;
+            if(values[dim_id] <= 0 || values[dim_id] > std::numeric_limits<int>::max()) {
+              throw std::runtime_error("the dataflow parameter " + dimensions[dim_id].GetName() + " must be a positive int");
+            }
+            bindings[dimensions[dim_id].GetName()] = static_cast<int>(values[dim_id]);
+          }
+          pragma_table = dataflow_template_->Bind(bindings, loop_info_table_);
+        }
+
+        for(int dim_id = 0; dim_id < static_cast<int>(values.size()); dim_id++) {
+          int pos = pragma_positions_[dim_id];
+          if(pos < 0) continue;
+
+          if(values[dim_id] <= 0 || values[dim_id] > std::numeric_limits<int>::max()) {
+            throw std::runtime_error("the map size " + dimensions[dim_id].GetName() + " must be a positive int");
+          }
+
+          auto new_entry = pragma_table->GetPragma(pos).GetEntry();
+          int size = static_cast<int>(values[dim_id]);
+          new_entry.offset = (new_entry.offset == new_entry.size)? size : new_entry.offset;
+          new_entry.size = size;
+          pragma_table = pragma_table->WithPragma(new_entry, pos);
+        }
+        return pragma_table;
+      }
+
+      /*
+       * Whether the hardware parameters fit the int arguments of the models: positive PE, ALU, and
+       * NoC bandwidth counts and prefetch depths, and non-negative hops and latencies
+       */
+      static bool FitsModels(const std::vector<long>& parameters) {
+        auto is_int = [](long value, long min_value) { return value >= min_value && value <= std::numeric_limits<int>::max(); };
+
+        return is_int(parameters[0], 1) && is_int(parameters[1], 1) && is_int(parameters[2], 1)
+               && is_int(parameters[3], 0) && is_int(parameters[4], 0) && is_int(parameters[9], 1)
+               && (parameters[7] <= 0 || (is_int(parameters[7], 1) && is_int(parameters[8], 0)));
+      }
+
+      /*
+       * Returns invalid metrics if the point cannot be analyzed. is_reused is set if the point
+       * is equivalent to one analyzed before, whose metrics are returned.
+       */
+      LayerMetrics Analyze(const SweepPoint& point, bool& is_reused) {
+        auto& parameters = point.parameters;
+
+        LayerMetrics invalid_metrics;
+        invalid_metrics.num_pes = static_cast<int>(std::min<long>(parameters[0], std::numeric_limits<int>::max()));
+        if(!FitsModels(parameters)) return invalid_metrics;
+        for(int dim_id = 0; dim_id < static_cast<int>(point.values.size()); dim_id++) {
+          if(pragma_positions_[dim_id] >= 0 && point.values[dim_id] <= 0) return invalid_metrics;
+        }
+
+        auto noc_model = std::make_shared<NetworkOnChipModel>(static_cast<int>(parameters[2]), static_cast<int>(parameters[3]),
+                                                              static_cast<int>(parameters[4]), parameters[5] != 0);
+        std::shared_ptr<OffChipMemoryModel> dram_model = nullptr;
+        if(parameters[7] > 0) {
+          dram_model = std::make_shared<OffChipMemoryModel>(static_cast<int>(parameters[7]), static_cast<int>(parameters[8]));
+        }
+
+        // A worker evaluates one point at a time, so the arena can be recycled here
+        auto& arena = EvaluationArena::GetThreadArena();
+        arena.Reset();
+
+        std::shared_ptr<PragmaTable> pragma_table;
+        try {
+          pragma_table = this->CreatePragmaTable(point.values);
+        }
+        catch(std::runtime_error& e) {
+          return invalid_metrics;
+        }
+
+        std::string mapping_key;
+        if(reuses_mappings_) {
+          pragma_table = CanonicalizeMapping(pragma_table, loop_info_table_);
+          mapping_key = GetMappingKey(*pragma_table);
+          for(auto& parameter : parameters) {
+            mapping_key += ' ' + std::to_string(parameter);
+          }
+
+          std::lock_guard<std::mutex> lock(analyzed_mappings_mutex_);
+          auto analyzed = analyzed_mappings_.find(mapping_key);
+          if(analyzed != analyzed_mappings_.end()) {
+            is_reused = true;
+            return analyzed->second;
+          }
+        }
+
+        LayerAnalysis layer(pragma_table, loop_info_table_, noc_model, static_cast<int>(parameters[0]));
+        layer.SetMemoryResource(arena.GetResource());
+        layer.SetNumALUsPerPE(static_cast<int>(parameters[1]));
+        layer.SetOffChipMemory(parameters[6], dram_model);
+        layer.SetSparseFormat(sparse_format_);
+        layer.SetReductionNetwork(reduction_model_);
+        layer.SetReduction(do_reduction_, do_implicit_reduction_);
+        layer.SetSynchronization(fg_sync_, true);
+        layer.SetPipeline(static_cast<int>(parameters[9]), parameters[10] != 0);
+        layer.Analyze();
+
+        auto metrics = layer.IsValid()? layer.GetMetrics() : invalid_metrics;
+
+        if(reuses_mappings_) {
+          std::lock_guard<std::mutex> lock(analyzed_mappings_mutex_);
+          if(analyzed_mappings_.size() >= max_analyzed_mappings_) {
+            analyzed_mappings_.clear();
+          }
+          analyzed_mappings_.emplace(mapping_key, metrics);
+        }
+
+        return metrics;
+      }
+
+      /*
+       * Whether every map steps over all values of its variable, so that the mapping performs every
+       * operation of the layer. A map that steps further than its tile spans (e.g., Temporal_Map (3,3)
+       * over Y with a 3-row filter, which computes every third output row) does less work than the
+       * lower bounds assume, and its runtime can be below them.
+       */
+      bool CoversLayer(std::shared_ptr<PragmaTable> pragma_table) {
+        for(auto pragma : *pragma_table) {
+          if(pragma.GetClass() != PragmaClass::TEMPORAL_MAP && pragma.GetClass() != PragmaClass::SPATIAL_MAP) continue;
+
+          auto loop = loop_info_table_->FindLoop(pragma.GetVarName());
+          if(loop == nullptr || pragma.GetSize() >= loop->GetExtent()) continue;
+
+          // Window positions of a tile whose whole filter window is in the tile
+          long span = pragma.GetSize();
+          auto window = loop_info_table_->FindSlidingWindow(pragma.GetVarName());
+          if(window != nullptr) {
+            auto filter_loop = loop_info_table_->FindLoop(window->GetFilterVariable());
+            long num_taps = std::min(span, (filter_loop != nullptr)? static_cast<long>(filter_loop->GetNumIter()) : 1L);
+            span = span - num_taps + 1;
+          }
+
+          if(pragma.GetOffset() > span) return false;
+        }
+        return true;
+      }
+
+      /*
+       * Whether the runtime lower bound of the hardware of the point already violates a constraint
+       * that caps the runtime, so that the point can be rejected without analyzing its mapping
+       */
+      bool ExceedsRuntimeBound(const SweepPoint& point) {
+        auto& parameters = point.parameters;
+        if(!has_runtime_caps_ || !FitsModels(parameters)) return false;
+
+        // The bound only holds for mappings that perform every operation of the layer
+        std::shared_ptr<PragmaTable> pragma_table;
+        try {
+          pragma_table = this->CreatePragmaTable(point.values);
+        }
+        catch(std::runtime_error& e) {
+          return false;
+        }
+        if(!this->CoversLayer(pragma_table)) return false;
+
+        auto noc_model = std::make_shared<NetworkOnChipModel>(static_cast<int>(parameters[2]), static_cast<int>(parameters[3]),
+                                                              static_cast<int>(parameters[4]), parameters[5] != 0);
+        std::shared_ptr<OffChipMemoryModel> dram_model = nullptr;
+        if(parameters[7] > 0) {
+          dram_model = std::make_shared<OffChipMemoryModel>(static_cast<int>(parameters[7]), static_cast<int>(parameters[8]));
+        }
+        auto sparsity_model = std::make_shared<SparsityModel>(sparse_format_, loop_info_table_->GetTensorDensities());
+
+        LowerBoundAnalysis bounds(loop_info_table_, noc_model, dram_model, sparsity_model, parameters[0], parameters[1]);
+        double runtime_bound = static_cast<double>(bounds.GetRuntimeBound());
+
+        for(auto& constraint : constraints_) {
+          bool lhs_is_runtime = (constraint.lhs.cls == OperandClass::METRIC && constraint.lhs.id == 0);
+          bool rhs_is_runtime = (constraint.rhs.cls == OperandClass::METRIC && constraint.rhs.id == 0);
+
+          if(lhs_is_runtime && constraint.rhs.cls != OperandClass::METRIC
+             && (constraint.op == ComparisonOp::LT || constraint.op == ComparisonOp::LE || constraint.op == ComparisonOp::EQ)
+             && !SweepConstraint::Compare(runtime_bound, constraint.op, this->GetOperandValue(constraint.rhs, point))) {
+            return true;
+          }
+          if(rhs_is_runtime && constraint.lhs.cls != OperandClass::METRIC
+             && (constraint.op == ComparisonOp::GT || constraint.op == ComparisonOp::GE || constraint.op == ComparisonOp::EQ)
+             && !SweepConstraint::Compare(this->GetOperandValue(constraint.lhs, point), constraint.op, runtime_bound)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void EvaluatePoint(long point_id, SweepPoint& point, SweepSummary& summary, std::ostream& csv_lines) {
+        point.point_id = point_id;
+        spec_->GetPoint(point_id, point.values);
+
+        point.parameters = default_parameters_;
+        for(int dim_id = 0; dim_id < static_cast<int>(point.values.size()); dim_id++) {
+          if(parameter_ids_[dim_id] >= 0) {
+            point.parameters[parameter_ids_[dim_id]] = point.values[dim_id];
+          }
+        }
+
+        summary.num_points++;
+        if(!this->SatisfiesConstraints(point, false)) {
+          summary.num_pruned++;
+          return;
+        }
+
+        if(this->ExceedsRuntimeBound(point)) {
+          summary.num_bounded++;
+          summary.num_rejected++;
+          return;
+        }
+
+        bool is_reused = false;
+        point.metrics = this->Analyze(point, is_reused);
+        if(is_reused) {
+          summary.num_reused++;
+        }
+        if(!point.metrics.valid) {
+          summary.num_invalid++;
+          return;
+        }
+
+        if(!this->SatisfiesConstraints(point, true)) {
+          summary.num_rejected++;
+          return;
+        }
+
+        summary.num_accepted++;
+        summary.UpdateBest(point);
+
+        csv_lines << point_id;
+        for(auto& value : point.values) {
+          csv_lines << "," << value;
+        }
+        csv_lines << "," << point.metrics.runtime << "," << point.metrics.energy
+                  << "," << point.metrics.l1_buffer_requirement << "," << point.metrics.l2_buffer_requirement
+                  << "," << point.metrics.dram_traffic << std::endl;
+      }
+
+    public:
+      /*
+       * Parameters of the dataflow template that are not swept take their values from bindings.
+       * Throws std::runtime_error if the specification refers to unknown parameters or map
+       * directives, or if the template cannot be bound.
+       */
+      DesignSpaceSweep(std::shared_ptr<SweepSpec> spec, std::shared_ptr<DataflowTemplate> dataflow, std::map<std::string, int> bindings,
+                       std::shared_ptr<LoopInfoTable> loop_tbl, Options& options) :
+        spec_(spec),
+        dataflow_template_(dataflow),
+        default_bindings_(bindings),
+        loop_info_table_(loop_tbl),
+        default_parameters_({options.np, options.num_alus_per_pe, options.bw, options.hops, options.hop_latency,
+                             options.mc, options.l2_size, options.dram_bw, options.dram_latency,
+                             options.prefetch_depth, options.drain_overlap}),
+        sparse_format_(SparseFormat::NONE),
+        reduction_model_(nullptr),
+        do_reduction_(options.do_reduction),
+        do_implicit_reduction_(options.do_implicit_reduction),
+        fg_sync_(options.fg_sync)
+      {
+        if(options.sparse_format == "bitmap") sparse_format_ = SparseFormat::BITMAP;
+        else if(options.sparse_format == "rle") sparse_format_ = SparseFormat::RLE;
+
+        ReductionNetwork topology;
+        if(ParseReductionNetwork(options.reduction_network, topology) && options.reduction_bw > 0 && options.reduction_latency >= 0) {
+          reduction_model_ = std::make_shared<ReductionNetworkModel>(topology, options.reduction_bw, options.reduction_latency, options.reduction_energy);
+        }
+
+        auto template_params = dataflow_template_->GetParameters();
+        for(auto& dimension : spec_->GetDimensions()) {
+          if(dimension.GetTarget() == SweepTarget::DATAFLOW_PARAMETER) {
+            if(FindName(template_params, dimension.GetName()) < 0) {
+              throw std::runtime_error("the dataflow has no parameter " + dimension.GetName());
+            }
+            default_bindings_.emplace(dimension.GetName(), 1); // Only a placeholder; every point binds it
+            binds_template_ = true;
+            reuses_mappings_ = true;
+          }
+        }
+        pragma_table_ = dataflow_template_->Bind(default_bindings_, loop_info_table_);
+
+        for(auto& dimension : spec_->GetDimensions()) {
+          int parameter_id = -1;
+          int pragma_pos = -1;
+
+          if(dimension.GetTarget() == SweepTarget::MAP_SIZE) {
+            reuses_mappings_ = true;
+            int pos = 0;
+            for(auto pragma : *pragma_table_) {
+              auto cls = pragma.GetClass();
+              if((cls == PragmaClass::TEMPORAL_MAP || cls == PragmaClass::SPATIAL_MAP) && pragma.GetVarName() == dimension.GetName()) {
+                pragma_pos = pos;
+                break;
+              }
+              pos++;
+            }
+            if(pragma_pos < 0) {
+              throw std::runtime_error("the dataflow has no map directive on " + dimension.GetName());
+            }
+          }
+          else if(dimension.GetTarget() == SweepTarget::HARDWARE) {
+            parameter_id = FindName(sweep_hardware_parameters, dimension.GetName());
+            if(parameter_id < 0) {
+              throw std::runtime_error("unknown swept parameter " + dimension.GetName());
+            }
+          }
+
+          parameter_ids_.push_back(parameter_id);
+          pragma_positions_.push_back(pragma_pos);
+        }
+
+        for(auto& constraint : spec_->GetConstraints()) {
+          ResolvedConstraint resolved;
+          resolved.lhs = this->ResolveOperand(constraint.lhs);
+          resolved.op = constraint.op;
+          resolved.rhs = this->ResolveOperand(constraint.rhs);
+          constraints_.push_back(resolved);
+
+          if((resolved.lhs.cls == OperandClass::METRIC && resolved.lhs.id == 0)
+             || (resolved.rhs.cls == OperandClass::METRIC && resolved.rhs.id == 0)) {
+            has_runtime_caps_ = true;
+          }
+        }
+      }
+
+      void WriteCSVHeader(std::ostream& csv) {
+        csv << "point";
+        for(auto& dimension : spec_->GetDimensions()) {
+          csv << "," << dimension.GetName();
+        }
+        csv << ",runtime,energy,l1_buffer_requirement,l2_buffer_requirement,dram_traffic" << std::endl;
+      }
+
+      /*
+       * Evaluates the whole space on num_threads threads (0: every hardware thread). Accepted points
+       * are written to csv, if given, as they are found; their order depends on the thread schedule.
+       */
+      SweepSummary Run(int num_threads, std::ostream* csv = nullptr) {
+        const long chunk_size = 64;
+        long num_points = spec_->GetNumPoints();
+
+        if(num_threads <= 0) {
+          num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        num_threads = static_cast<int>(std::min<long>(num_threads, std::max<long>(1, (num_points + chunk_size - 1) / chunk_size)));
+
+        std::atomic<long> next_point_id(0);
+        std::mutex summary_mutex;
+        SweepSummary summary;
+
+        auto run_worker = [&]() {
+          SweepSummary thread_summary;
+          SweepPoint point;
+          std::ostringstream csv_lines;
+
+          while(true) {
+            long begin = next_point_id.fetch_add(chunk_size);
+            if(begin >= num_points) break;
+            long end = std::min(num_points, begin + chunk_size);
+
+            for(long point_id = begin; point_id < end; point_id++) {
+              this->EvaluatePoint(point_id, point, thread_summary, csv_lines);
+            }
+
+            if(csv != nullptr && csv_lines.tellp() > 0) {
+              std::lock_guard<std::mutex> lock(summary_mutex);
+              *csv << csv_lines.str();
+            }
+            csv_lines.str("");
+          }
+
+          std::lock_guard<std::mutex> lock(summary_mutex);
+          summary.Merge(thread_summary);
+        };
+
+        std::vector<std::thread> workers;
+        for(int thread_id = 1; thread_id < num_threads; thread_id++) {
+          workers.emplace_back(run_worker);
+        }
+        run_worker();
+
+        for(auto& worker : workers) {
+          worker.join();
+        }
+
+        return summary;
+      }
+
+      std::shared_ptr<SweepSpec> GetSpec() {
+        return spec_;
+      }
+  }; // End of class DesignSpaceSweep
+
+}; // End of namespace maestro
+
+#endif
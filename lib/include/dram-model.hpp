@@ -0,0 +1,73 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_DRAM_MODEL_HPP_
+#define MAESTRO_DRAM_MODEL_HPP_
+
+#include <stdexcept>
+
+namespace maestro {
+
+  class OffChipMemoryModel {
+    protected:
+      int bandwidth_;
+      int latency_;
+
+    public:
+      OffChipMemoryModel(int bw, int latency) :
+        bandwidth_(bw),
+        latency_(latency)
+      {
+        if(bw <= 0 || latency < 0) {
+          throw std::runtime_error("the DRAM bandwidth must be positive and its latency non-negative");
+        }
+      }
+
+      int GetBandwidth() {
+        return bandwidth_;
+      }
+
+      int GetLatency() {
+        return latency_;
+      }
+
+      // Cycles to stream data_amount bytes once the request pipeline is full
+      long GetStreamingDelay(long data_amount) {
+        if(data_amount <= 0) return 0;
+
+        long num_bursts = data_amount / bandwidth_;
+        if(data_amount % bandwidth_ != 0) {
+          num_bursts++;
+        }
+
+        return num_bursts;
+      }
+
+      long GetOutStandingDelay(long data_amount) {
+        if(data_amount <= 0) return 0;
+
+        long delay = latency_ // Access latency
+                     + this->GetStreamingDelay(data_amount); // Transfer delay
+
+        return delay;
+      } // End of GetOutStandingDelay
+  }; // End of class OffChipMemoryModel
+
+}; // End of namespace maestro
+#endif
@@ -0,0 +1,100 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_EVALUATION_ARENA_HPP_
+#define MAESTRO_EVALUATION_ARENA_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <optional>
+#include <memory_resource>
+
+namespace maestro {
+
+  /*
+   * Memory for the analysis objects of one design point. Allocations are carved out of one
+   * buffer and all freed by Reset(), so a worker evaluating points in a loop stops calling
+   * malloc once the buffer has grown to the size of one evaluation.
+   * Everything allocated from the arena must be destroyed before Reset().
+   */
+  class EvaluationArena {
+    protected:
+      // Counts what did not fit in the buffer, so that Reset() can grow it
+      class OverflowResource : public std::pmr::memory_resource {
+        public:
+          std::size_t allocated_bytes = 0;
+
+        protected:
+          void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            allocated_bytes += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+          }
+
+          void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+          }
+
+          bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+          }
+      }; // End of class OverflowResource
+
+      std::vector<std::byte> buffer_;
+      OverflowResource overflow_;
+      std::optional<std::pmr::monotonic_buffer_resource> resource_;
+
+    public:
+      EvaluationArena(std::size_t initial_size = 64 * 1024) :
+        buffer_(initial_size)
+      {
+        resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+      }
+
+      EvaluationArena(const EvaluationArena&) = delete;
+      EvaluationArena& operator=(const EvaluationArena&) = delete;
+
+      std::pmr::memory_resource* GetResource() {
+        return &(*resource_);
+      }
+
+      std::size_t GetCapacity() {
+        return buffer_.size();
+      }
+
+      void Reset() {
+        resource_.reset();
+
+        if(overflow_.allocated_bytes > 0) {
+          buffer_ = std::vector<std::byte>(2 * (buffer_.size() + overflow_.allocated_bytes));
+          overflow_.allocated_bytes = 0;
+        }
+
+        resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+      }
+
+      // One arena per worker thread
+      static EvaluationArena& GetThreadArena() {
+        thread_local EvaluationArena arena;
+        return arena;
+      }
+  }; // End of class EvaluationArena
+
+}; // End of namespace maestro
+
+#endif
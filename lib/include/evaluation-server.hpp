@@ -0,0 +1,638 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_EVALUATION_SERVER_HPP_
+#define MAESTRO_EVALUATION_SERVER_HPP_
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "option.hpp"
+#include "parser.hpp"
+#include "analysis-structure.hpp"
+#include "dataflow-template.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "layer-analysis.hpp"
+#include "evaluation-arena.hpp"
+
+namespace maestro {
+
+  /*
+   * Line protocol of the evaluation server. A request is one line:
+   *
+   *   <id> <key>=<value> <key>=<value> ...
+   *
+   * Keys are the command line options of the hardware (num_pes, num_pe_alus, noc_bw, noc_hops, noc_hop_latency,
+   * noc_mc_support, l2_size, dram_bw, dram_latency, sparse_format, do_reduction_op, do_implicit_reduction,
+   * prefetch_depth, drain_overlap, reduction_network, reduction_bw, reduction_latency, reduction_energy),
+   * dataflow_file and layer_file (paths), dataflow and layer (the description text itself), or
+   * param.<name> for a parameter of a dataflow template (e.g., param.Tk=4).
+   * Values are percent-encoded (e.g., %20 for a space and %0A for a newline). Unspecified keys keep the
+   * values given to the server on its command line. The response is one line with the same id:
+   *
+   *   <id> ok runtime=<cycles> energy=<MAC energy> l1_buffer_requirement=... l2_buffer_requirement=... ...
+   *   <id> error <message>
+   *
+   * Requests are evaluated concurrently, so responses may come back in a different order than requests.
+   */
+
+  /*
+   * Output side of one client. Responses are queued and written by a thread of the connection, so workers
+   * never wait for a client that sends all of its requests before it reads any response.
+   */
+  class ServerConnection {
+    protected:
+      int out_fd_;
+      bool owns_fd_;
+
+      std::deque<std::string> pending_responses_;
+      std::mutex pending_mutex_;
+      std::condition_variable has_pending_;
+      bool closing_;
+      std::thread writer_;
+
+      void WriteAll(const std::string& data) {
+        std::size_t offset = 0;
+        while(offset < data.size()) {
+          ssize_t written = write(out_fd_, data.data() + offset, data.size() - offset);
+          if(written < 0) {
+            if(errno == EINTR) continue;
+            return; // The client went away
+          }
+          offset += written;
+        }
+      }
+
+      void RunWriter() {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        while(true) {
+          has_pending_.wait(lock, [this]() { return closing_ || !pending_responses_.empty(); });
+          if(pending_responses_.empty()) return;
+
+          std::string batch;
+          for(auto& response : pending_responses_) {
+            batch += response;
+          }
+          pending_responses_.clear();
+
+          lock.unlock();
+          this->WriteAll(batch);
+          lock.lock();
+        }
+      }
+
+    public:
+      ServerConnection(int out_fd, bool owns_fd) :
+        out_fd_(out_fd),
+        owns_fd_(owns_fd),
+        closing_(false)
+      {
+        writer_ = std::thread([this]() { this->RunWriter(); });
+      }
+
+      // Flushes the queued responses
+      ~ServerConnection() {
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          closing_ = true;
+        }
+        has_pending_.notify_one();
+        writer_.join();
+
+        if(owns_fd_) close(out_fd_);
+      }
+
+      void Send(std::string line) {
+        {
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          pending_responses_.push_back(std::move(line));
+        }
+        has_pending_.notify_one();
+      }
+  }; // End of class ServerConnection
+
+  class ServerRequest {
+    public:
+      std::string line;
+      std::shared_ptr<ServerConnection> connection;
+  }; // End of class ServerRequest
+
+  class EvaluationServer {
+    protected:
+      Options defaults_;
+      int num_workers_;
+      std::size_t max_queued_requests_;
+
+      std::vector<std::thread> workers_;
+      std::deque<ServerRequest> queue_;
+      std::mutex queue_mutex_;
+      std::condition_variable queue_not_empty_;
+      std::condition_variable queue_not_full_;
+      bool stopping_;
+
+      // Parsed descriptions by their source; they are only read during evaluation
+      using Descriptions = std::pair<std::shared_ptr<DataflowTemplate>, std::shared_ptr<LoopInfoTable>>;
+      static constexpr std::size_t max_cached_descriptions_ = 256;
+      const std::string param_prefix_ = "param."; // Keys that bind parameters of a dataflow template
+      std::map<std::string, Descriptions> description_cache_;
+      std::mutex cache_mutex_;
+
+    public:
+      // Requests are evaluated on num_workers threads; 0 uses every hardware thread
+      EvaluationServer(Options defaults, int num_workers) :
+        defaults_(defaults),
+        num_workers_(num_workers > 0? num_workers : std::max(1u, std::thread::hardware_concurrency())),
+        max_queued_requests_(64 * static_cast<std::size_t>(num_workers_)),
+        stopping_(false)
+      {
+      }
+
+      ~EvaluationServer() {
+        this->Stop();
+      }
+
+      // Serves requests from stdin until it is closed. Diagnostics of the parsers are redirected to stderr.
+      void ServeStdio() {
+        std::cout.flush();
+        auto cout_buffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+        this->Start();
+        auto connection = std::make_shared<ServerConnection>(STDOUT_FILENO, false);
+        this->ReadRequests(STDIN_FILENO, connection);
+        this->Stop();
+
+        std::cout.rdbuf(cout_buffer);
+      }
+
+      // Serves every client that connects to a Unix domain socket at path; only returns on an error
+      int ServeSocket(std::string path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(address.sun_path)) {
+          std::cerr << "[MAESTRO] Error; the socket path is too long: " << path << std::endl;
+          return 1;
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path.c_str());
+        if(listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+           || listen(listen_fd, SOMAXCONN) < 0) {
+          std::cerr << "[MAESTRO] Error; cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+          if(listen_fd >= 0) close(listen_fd);
+          return 1;
+        }
+
+        std::cout.rdbuf(std::cerr.rdbuf());
+        this->Start();
+
+        while(true) {
+          int client_fd = accept(listen_fd, nullptr, nullptr);
+          if(client_fd < 0) {
+            if(errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+          }
+
+          // The connection closes the socket once the reader and every pending response are done with it
+          auto connection = std::make_shared<ServerConnection>(client_fd, true);
+          std::thread([this, client_fd, connection]() {
+            this->ReadRequests(client_fd, connection);
+          }).detach();
+        }
+
+        std::cerr << "[MAESTRO] Error; accept failed: " << std::strerror(errno) << std::endl;
+        close(listen_fd);
+        return 1;
+      }
+
+      // Evaluates one request line and returns the response line (without the newline)
+      std::string HandleRequest(const std::string& line) {
+        std::istringstream tokens(line);
+        std::string id;
+        tokens >> id;
+
+        std::ostringstream response;
+        response << id;
+
+        try {
+          std::map<std::string, std::string> fields;
+          std::string token;
+          while(tokens >> token) {
+            auto separator = token.find('=');
+            if(separator == std::string::npos) {
+              throw std::runtime_error("expected key=value, got " + token);
+            }
+            fields[token.substr(0, separator)] = DecodeValue(token.substr(separator + 1));
+          }
+
+          auto metrics = this->Evaluate(fields);
+
+          response << std::setprecision(12)
+                   << " ok runtime=" << metrics.runtime
+                   << " energy=" << metrics.energy
+                   << " l1_buffer_requirement=" << metrics.l1_buffer_requirement
+                   << " l2_buffer_requirement=" << metrics.l2_buffer_requirement
+                   << " dram_traffic=" << metrics.dram_traffic
+                   << " total_ops=" << metrics.total_ops
+                   << " num_temporal_iterations=" << metrics.num_temporal_iterations
+                   << " num_spatial_foldings=" << metrics.num_spatial_foldings
+                   << " batch_size=" << metrics.batch_size
+                   << " runtime_per_sample=" << metrics.runtime_per_sample
+                   << " energy_per_sample=" << metrics.energy_per_sample
+                   << " runtime_bound=" << metrics.runtime_bound
+                   << " l2_traffic=" << metrics.l2_traffic
+                   << " l2_traffic_bound=" << metrics.l2_traffic_bound
+                   << " pe_utilization=" << metrics.pe_utilization
+                   << " noc_utilization=" << metrics.noc_utilization
+                   << " bottleneck=" << GetBottleneckKey(metrics.bottleneck);
+        }
+        catch(std::exception& e) {
+          std::string message = e.what();
+          std::replace(message.begin(), message.end(), '\n', ' ');
+          response << " error " << message;
+        }
+
+        return response.str();
+      }
+
+    protected:
+      void Start() {
+        // A client that disconnects with pending responses must not terminate the server
+        signal(SIGPIPE, SIG_IGN);
+
+        stopping_ = false;
+        for(int worker_id = 0; worker_id < num_workers_; worker_id++) {
+          workers_.emplace_back([this]() { this->RunWorker(); });
+        }
+      }
+
+      // Lets the workers finish every queued request, then joins them
+      void Stop() {
+        {
+          std::lock_guard<std::mutex> lock(queue_mutex_);
+          stopping_ = true;
+        }
+        queue_not_empty_.notify_all();
+
+        for(auto& worker : workers_) {
+          worker.join();
+        }
+        workers_.clear();
+      }
+
+      void ReadRequests(int in_fd, std::shared_ptr<ServerConnection> connection) {
+        std::string buffer;
+        std::size_t line_begin = 0;
+        char chunk[65536];
+
+        while(true) {
+          auto line_end = buffer.find('\n', line_begin);
+          if(line_end == std::string::npos) {
+            buffer.erase(0, line_begin);
+            line_begin = 0;
+
+            ssize_t num_read = read(in_fd, chunk, sizeof(chunk));
+            if(num_read < 0 && errno == EINTR) continue;
+            if(num_read <= 0) break;
+
+            buffer.append(chunk, num_read);
+            continue;
+          }
+
+          this->Submit(buffer.substr(line_begin, line_end - line_begin), connection);
+          line_begin = line_end + 1;
+        }
+
+        // The last request may not end with a newline
+        this->Submit(buffer.substr(line_begin), connection);
+      }
+
+      void Submit(std::string line, std::shared_ptr<ServerConnection> connection) {
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.find_first_not_of(" \t") == std::string::npos) return;
+
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        // Clients that pipeline faster than the workers evaluate are slowed down here
+        queue_not_full_.wait(lock, [this]() { return queue_.size() < max_queued_requests_; });
+
+        ServerRequest request;
+        request.line = std::move(line);
+        request.connection = connection;
+        queue_.push_back(std::move(request));
+
+        lock.unlock();
+        queue_not_empty_.notify_one();
+      }
+
+      void RunWorker() {
+        while(true) {
+          ServerRequest request;
+          {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_not_empty_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if(queue_.empty()) return;
+
+            request = std::move(queue_.front());
+            queue_.pop_front();
+          }
+          queue_not_full_.notify_one();
+
+          request.connection->Send(this->HandleRequest(request.line) + "\n");
+        }
+      }
+
+      static std::string DecodeValue(const std::string& value) {
+        std::string ret;
+        for(std::size_t pos = 0; pos < value.size(); pos++) {
+          if(value[pos] != '%') {
+            ret.push_back(value[pos]);
+            continue;
+          }
+
+          if(pos + 2 >= value.size() || !std::isxdigit(value[pos+1]) || !std::isxdigit(value[pos+2])) {
+            throw std::runtime_error("invalid percent encoding in " + value);
+          }
+          ret.push_back(static_cast<char>(std::stoi(value.substr(pos+1, 2), nullptr, 16)));
+          pos += 2;
+        }
+        return ret;
+      }
+
+      static std::string GetBottleneckKey(RuntimeResource resource) {
+        switch(resource) {
+          case RuntimeResource::NOC_IN: return "noc_in";
+          case RuntimeResource::NOC_OUT: return "noc_out";
+          case RuntimeResource::COMPUTE: return "compute";
+          default: return "dram";
+        }
+      }
+
+      static long ParseInteger(const std::string& key, const std::string& value) {
+        std::size_t length = 0;
+        long ret = 0;
+        try {
+          ret = std::stol(value, &length);
+        }
+        catch(std::exception& e) {
+          length = 0;
+        }
+        if(length == 0 || length != value.size()) {
+          throw std::runtime_error("invalid value of " + key + ": " + value);
+        }
+        return ret;
+      }
+
+      static double ParseDouble(const std::string& key, const std::string& value) {
+        std::size_t length = 0;
+        double ret = 0.0;
+        try {
+          ret = std::stod(value, &length);
+        }
+        catch(std::exception& e) {
+          length = 0;
+        }
+        if(length == 0 || length != value.size()) {
+          throw std::runtime_error("invalid value of " + key + ": " + value);
+        }
+        return ret;
+      }
+
+      static bool ParseBool(const std::string& key, const std::string& value) {
+        if(value == "1" || value == "true") return true;
+        if(value == "0" || value == "false") return false;
+        throw std::runtime_error("invalid value of " + key + ": " + value);
+      }
+
+      static SparseFormat ParseSparseFormat(const std::string& value) {
+        if(value == "none") return SparseFormat::NONE;
+        if(value == "bitmap") return SparseFormat::BITMAP;
+        if(value == "rle") return SparseFormat::RLE;
+        throw std::runtime_error("unknown sparse format " + value);
+      }
+
+      static std::string ReadFile(const std::string& file_name) {
+        std::ifstream in_file(file_name);
+        if(!in_file) {
+          throw std::runtime_error("cannot open " + file_name);
+        }
+        std::ostringstream text;
+        text << in_file.rdbuf();
+        return text.str();
+      }
+
+      // Files are read once; later requests that name the same file use the parsed tables
+      Descriptions GetDescriptions(std::map<std::string, std::string>& fields) {
+        std::string dataflow_key = fields.count("dataflow")? "text:" + fields["dataflow"]
+                                 : "file:" + (fields.count("dataflow_file")? fields["dataflow_file"] : defaults_.dataflow_file_name);
+        std::string layer_key = fields.count("layer")? "text:" + fields["layer"]
+                              : "file:" + (fields.count("layer_file")? fields["layer_file"] : defaults_.layer_file_name);
+        std::string key = dataflow_key + '\0' + layer_key;
+
+        {
+          std::lock_guard<std::mutex> lock(cache_mutex_);
+          auto cached = description_cache_.find(key);
+          if(cached != description_cache_.end()) return cached->second;
+        }
+
+        std::string dataflow_text = fields.count("dataflow")? fields["dataflow"] : ReadFile(dataflow_key.substr(5));
+        std::string layer_text = fields.count("layer")? fields["layer"] : ReadFile(layer_key.substr(5));
+
+        PragmaParser prag_parser(std::make_shared<std::istringstream>(dataflow_text));
+        auto dataflow = prag_parser.ParseTemplate();
+        auto pragma_table = dataflow->GetPragmaTable();
+        if(!(pragma_table->begin() != pragma_table->end())) {
+          throw std::runtime_error("the dataflow description has no directives");
+        }
+
+        ProblemParser prob_parser(std::make_shared<std::istringstream>(layer_text));
+        auto loop_info_table = prob_parser.ParseProblem();
+        if(loop_info_table->begin() == loop_info_table->end()) {
+          throw std::runtime_error("the layer description has no loops");
+        }
+
+        // The analysis looks up the loop of every mapped and every tensor variable
+        for(auto pragma : *pragma_table) {
+          bool needs_loop = pragma.GetClass() == PragmaClass::TEMPORAL_MAP || pragma.GetClass() == PragmaClass::SPATIAL_MAP
+                            || pragma.GetClass() == PragmaClass::UNROLL;
+          if(needs_loop && loop_info_table->FindLoop(pragma.GetVarName()) == nullptr) {
+            throw std::runtime_error("the dataflow maps " + pragma.GetVarName() + ", which is not a loop of the layer");
+          }
+        }
+        for(auto& tensor : loop_info_table->GetOperator()->GetTensorInformation()) {
+          for(auto& var : tensor->GetVariables()) {
+            if(loop_info_table->FindLoop(var) == nullptr) {
+              throw std::runtime_error("tensor " + tensor->GetName() + " is indexed by " + var + ", which is not a loop of the layer");
+            }
+          }
+        }
+
+        Descriptions descriptions(dataflow, loop_info_table);
+
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if(description_cache_.size() >= max_cached_descriptions_) {
+          description_cache_.clear();
+        }
+        description_cache_[key] = descriptions;
+
+        return descriptions;
+      }
+
+      LayerMetrics Evaluate(std::map<std::string, std::string>& fields) {
+        long num_pes = defaults_.np;
+        long num_alus_per_pe = defaults_.num_alus_per_pe;
+        long noc_bw = defaults_.bw;
+        long noc_hops = defaults_.hops;
+        long noc_hop_latency = defaults_.hop_latency;
+        bool noc_multicast = defaults_.mc;
+        long l2_size = defaults_.l2_size;
+        long dram_bw = defaults_.dram_bw;
+        long dram_latency = defaults_.dram_latency;
+        std::string sparse_format = defaults_.sparse_format;
+        bool do_reduction = defaults_.do_reduction;
+        bool do_implicit_reduction = defaults_.do_implicit_reduction;
+        long prefetch_depth = defaults_.prefetch_depth;
+        bool drain_overlap = defaults_.drain_overlap;
+        std::string reduction_network = defaults_.reduction_network;
+        long reduction_bw = defaults_.reduction_bw;
+        long reduction_latency = defaults_.reduction_latency;
+        double reduction_energy = defaults_.reduction_energy;
+        auto dataflow_params = ParseTemplateBindings(defaults_.dataflow_params);
+
+        for(auto& field : fields) {
+          auto& key = field.first;
+          auto& value = field.second;
+
+          if(key == "num_pes") num_pes = ParseInteger(key, value);
+          else if(key == "num_pe_alus") num_alus_per_pe = ParseInteger(key, value);
+          else if(key == "noc_bw") noc_bw = ParseInteger(key, value);
+          else if(key == "noc_hops") noc_hops = ParseInteger(key, value);
+          else if(key == "noc_hop_latency") noc_hop_latency = ParseInteger(key, value);
+          else if(key == "noc_mc_support") noc_multicast = ParseBool(key, value);
+          else if(key == "l2_size") l2_size = ParseInteger(key, value);
+          else if(key == "dram_bw") dram_bw = ParseInteger(key, value);
+          else if(key == "dram_latency") dram_latency = ParseInteger(key, value);
+          else if(key == "sparse_format") sparse_format = value;
+          else if(key == "do_reduction_op") do_reduction = ParseBool(key, value);
+          else if(key == "do_implicit_reduction") do_implicit_reduction = ParseBool(key, value);
+          else if(key == "prefetch_depth") prefetch_depth = ParseInteger(key, value);
+          else if(key == "drain_overlap") drain_overlap = ParseBool(key, value);
+          else if(key == "reduction_network") reduction_network = value;
+          else if(key == "reduction_bw") reduction_bw = ParseInteger(key, value);
+          else if(key == "reduction_latency") reduction_latency = ParseInteger(key, value);
+          else if(key == "reduction_energy") reduction_energy = ParseDouble(key, value);
+          else if(key.compare(0, param_prefix_.size(), param_prefix_) == 0) {
+            long param = ParseInteger(key, value);
+            if(param > std::numeric_limits<int>::max()) {
+              throw std::runtime_error(key + " is too large");
+            }
+            dataflow_params[key.substr(param_prefix_.size())] = static_cast<int>(param);
+          }
+          else if(key != "dataflow" && key != "dataflow_file" && key != "layer" && key != "layer_file") {
+            throw std::runtime_error("unknown key " + key);
+          }
+        }
+
+        const long max_int = std::numeric_limits<int>::max();
+        if(num_pes <= 0 || num_pes > max_int || num_alus_per_pe <= 0 || num_alus_per_pe > max_int
+           || noc_bw <= 0 || noc_bw > max_int) {
+          throw std::runtime_error("num_pes, num_pe_alus, and noc_bw must be positive ints");
+        }
+        if(noc_hops < 0 || noc_hops > max_int || noc_hop_latency < 0 || noc_hop_latency > max_int) {
+          throw std::runtime_error("noc_hops and noc_hop_latency must be non-negative ints");
+        }
+        if(dram_bw < 0 || dram_bw > max_int || dram_latency < 0 || dram_latency > max_int) {
+          throw std::runtime_error("dram_bw and dram_latency must be non-negative ints");
+        }
+        if(prefetch_depth <= 0 || prefetch_depth > max_int) {
+          throw std::runtime_error("prefetch_depth must be a positive int");
+        }
+        ReductionNetwork reduction_topology;
+        if(!ParseReductionNetwork(reduction_network, reduction_topology)) {
+          throw std::runtime_error("unknown reduction network " + reduction_network);
+        }
+        if(reduction_bw <= 0 || reduction_bw > max_int || reduction_latency < 0 || reduction_latency > max_int) {
+          throw std::runtime_error("reduction_bw must be a positive int and reduction_latency a non-negative int");
+        }
+
+        auto descriptions = this->GetDescriptions(fields);
+
+        auto noc_model = std::make_shared<NetworkOnChipModel>(static_cast<int>(noc_bw), static_cast<int>(noc_hops),
+                                                              static_cast<int>(noc_hop_latency), noc_multicast);
+        std::shared_ptr<OffChipMemoryModel> dram_model = nullptr;
+        if(dram_bw > 0) {
+          dram_model = std::make_shared<OffChipMemoryModel>(static_cast<int>(dram_bw), static_cast<int>(dram_latency));
+        }
+
+        // A worker evaluates one request at a time, so the arena can be recycled here
+        auto& arena = EvaluationArena::GetThreadArena();
+        arena.Reset();
+
+        auto pragma_table = descriptions.first->Bind(dataflow_params, descriptions.second);
+
+        LayerAnalysis layer(pragma_table, descriptions.second, noc_model, static_cast<int>(num_pes));
+
+        layer.SetMemoryResource(arena.GetResource());
+        layer.SetNumALUsPerPE(static_cast<int>(num_alus_per_pe));
+        layer.SetOffChipMemory(l2_size, dram_model);
+        layer.SetSparseFormat(ParseSparseFormat(sparse_format));
+        layer.SetReduction(do_reduction, do_implicit_reduction);
+        layer.SetSynchronization(defaults_.fg_sync, true);
+        layer.SetPipeline(static_cast<int>(prefetch_depth), drain_overlap);
+        layer.SetReductionNetwork(std::make_shared<ReductionNetworkModel>(reduction_topology, static_cast<int>(reduction_bw),
+                                                                          static_cast<int>(reduction_latency), reduction_energy));
+        layer.Analyze();
+
+        if(!layer.IsValid()) {
+          if(layer.GetMetrics().error == LayerAnalysisError::NOT_ENOUGH_PES) {
+            throw std::runtime_error("not enough PEs for the dataflow (minimum " + std::to_string(layer.GetMinNumPEs()) + ")");
+          }
+          throw std::runtime_error("sizes of the design point exceed 64-bit arithmetic");
+        }
+
+        return layer.GetMetrics();
+      }
+  }; // End of class EvaluationServer
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,478 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_LAYER_ANALYSIS_HPP_
+#define MAESTRO_LAYER_ANALYSIS_HPP_
+
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+
+#include "analysis-structure.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "mapping-analysis.hpp"
+#include "cost-analysis.hpp"
+#include "lower-bound-analysis.hpp"
+#include "checked-arithmetic.hpp"
+
+namespace maestro {
+
+  // Why an analyzed design point is invalid
+  enum class LayerAnalysisError {
+    NONE,
+    NOT_ENOUGH_PES,     // Fewer PEs than one instance of every cluster in the dataflow
+    ARITHMETIC_OVERFLOW // A size or delay exceeds 64-bit arithmetic
+  };
+
+  // Summary of one analyzed design point; valid is false if the layer does not fit on num_pes or its sizes overflow 64 bits
+  class LayerMetrics {
+    public:
+      int num_pes = 0;
+      bool valid = false;
+      LayerAnalysisError error = LayerAnalysisError::NONE;
+
+      long runtime = -1;
+      double energy = 0;
+      long l1_buffer_requirement = 0;
+      long l2_buffer_requirement = 0;
+      long dram_traffic = 0;
+      long total_ops = 0;
+      long num_temporal_iterations = 0;
+      long num_spatial_foldings = 0;
+      int batch_size = 1;
+      double runtime_per_sample = 0;
+      double energy_per_sample = 0;
+
+      long runtime_bound = 0;     // No mapping of the layer on this hardware is faster
+      long l2_traffic = 0;        // L2 reads of inputs and partial sums written back
+      long l2_traffic_bound = 0;
+      double pe_utilization = 0;  // Fraction of the ALU cycles doing effectual operations
+      double noc_utilization = 0; // Fraction of the NoC bandwidth used in the busier direction
+      RuntimeResource bottleneck = RuntimeResource::COMPUTE; // The resource that bounds most cycles
+  }; // End of class LayerMetrics
+
+  /*
+   * Self-contained analysis of one layer on one accelerator configuration.
+   * Unlike the functions in maestro.cpp, it owns all of its state, so several
+   * layers (or design points) can be analyzed side by side.
+   */
+  class LayerAnalysis {
+    protected:
+      std::shared_ptr<PragmaTable> pragma_table_;
+      std::shared_ptr<LoopInfoTable> loop_info_table_;
+      std::shared_ptr<NetworkOnChipModel> noc_model_;
+      std::shared_ptr<OffChipMemoryModel> dram_model_;
+      std::shared_ptr<SparsityModel> sparsity_model_;
+      std::shared_ptr<ReductionNetworkModel> reduction_model_; // nullptr: L2 accumulates partial sums
+
+      std::shared_ptr<MappingAnalysis> map_analysis_;
+      std::shared_ptr<BufferAnalysis> buffer_analysis_;
+      std::shared_ptr<PerformanceAnalysis> perf_analysis_;
+
+      std::list<std::string> input_tensors_;
+      std::list<std::string> output_tensors_;
+      std::list<std::string> tensors_;
+
+      int num_pes_;
+      int num_alus_per_pe_;
+      long l2_size_;
+
+      bool do_reduction_;
+      bool do_implicit_reduction_;
+      bool fg_sync_;
+      bool latency_hiding_;
+      int prefetch_depth_;
+      bool drain_overlap_;
+
+      long runtime_;
+      RuntimeBreakdown runtime_breakdown_;
+      bool valid_;
+      LayerMetrics metrics_;
+
+      std::pmr::memory_resource* resource_;
+
+    public:
+      LayerAnalysis(std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl,
+                    std::shared_ptr<NetworkOnChipModel> noc_model, int num_pes) :
+        pragma_table_(prag_tbl),
+        loop_info_table_(loop_tbl),
+        noc_model_(noc_model),
+        dram_model_(nullptr),
+        sparsity_model_(std::make_shared<SparsityModel>(SparseFormat::NONE, loop_tbl->GetTensorDensities())),
+        reduction_model_(nullptr),
+        input_tensors_(loop_tbl->GetOperator()->GetInputTensors()),
+        output_tensors_(loop_tbl->GetOperator()->GetOutputTensors()),
+        tensors_(JoinTensors(input_tensors_, output_tensors_)),
+        num_pes_(num_pes),
+        num_alus_per_pe_(1),
+        l2_size_(0),
+        do_reduction_(true),
+        do_implicit_reduction_(true),
+        fg_sync_(false),
+        latency_hiding_(true),
+        prefetch_depth_(2),
+        drain_overlap_(false),
+        runtime_(0),
+        valid_(false),
+        resource_(std::pmr::get_default_resource())
+      {
+      }
+
+      void SetNumPEs(int num_pes) {
+        num_pes_ = num_pes;
+      }
+
+      void SetNumALUsPerPE(int num_alus_per_pe) {
+        num_alus_per_pe_ = num_alus_per_pe;
+      }
+
+      void SetOffChipMemory(long l2_size, std::shared_ptr<OffChipMemoryModel> dram_model) {
+        l2_size_ = l2_size;
+        dram_model_ = dram_model;
+      }
+
+      // Densities come from the layer; the format from the accelerator
+      void SetSparseFormat(SparseFormat sparse_format) {
+        sparsity_model_ = std::make_shared<SparsityModel>(sparse_format, loop_info_table_->GetTensorDensities());
+      }
+
+      void SetReductionNetwork(std::shared_ptr<ReductionNetworkModel> reduction_model) {
+        reduction_model_ = reduction_model;
+      }
+
+      void SetReduction(bool do_reduction, bool do_implicit_reduction) {
+        do_reduction_ = do_reduction;
+        do_implicit_reduction_ = do_implicit_reduction;
+      }
+
+      void SetSynchronization(bool fg_sync, bool latency_hiding) {
+        fg_sync_ = fg_sync;
+        latency_hiding_ = latency_hiding;
+      }
+
+      // Input tiles each PE buffers (2: double buffering), and if outputs drain while the next fold computes
+      void SetPipeline(int prefetch_depth, bool drain_overlap) {
+        prefetch_depth_ = prefetch_depth;
+        drain_overlap_ = drain_overlap;
+      }
+
+      /*
+       * Memory for the analysis objects of the next Analyze() or SweepNumPEs() calls, e.g., an
+       * EvaluationArena; it must outlive this object and the analyses obtained from it.
+       */
+      void SetMemoryResource(std::pmr::memory_resource* resource) {
+        resource_ = resource;
+      }
+
+      // Same hardware and options for another mapping or problem (e.g., a slice of the layer); not analyzed yet
+      std::shared_ptr<LayerAnalysis> WithProblem(std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl) {
+        auto ret = std::make_shared<LayerAnalysis>(*this);
+        ret->pragma_table_ = prag_tbl;
+        ret->loop_info_table_ = loop_tbl;
+        ret->input_tensors_ = loop_tbl->GetOperator()->GetInputTensors();
+        ret->output_tensors_ = loop_tbl->GetOperator()->GetOutputTensors();
+        ret->tensors_ = JoinTensors(ret->input_tensors_, ret->output_tensors_);
+        ret->map_analysis_ = nullptr;
+        ret->buffer_analysis_ = nullptr;
+        ret->perf_analysis_ = nullptr;
+        ret->Invalidate();
+
+        return ret;
+      }
+
+      /*
+       * A design point with fewer PEs than the clusters of its dataflow, or whose sizes or delays
+       * overflow 64 bits, is left invalid with a runtime of -1; GetMetrics().error tells which
+       */
+      void Analyze() {
+        if(num_pes_ < this->GetMinNumPEs()) {
+          this->Invalidate(LayerAnalysisError::NOT_ENOUGH_PES);
+          return;
+        }
+
+        try {
+          map_analysis_ = this->CreateMappingAnalysis();
+          map_analysis_->PreProcess(num_pes_);
+
+          this->AnalyzeCost();
+        }
+        catch(ArithmeticOverflow& e) {
+          this->Invalidate(LayerAnalysisError::ARITHMETIC_OVERFLOW);
+        }
+      }
+
+      /*
+       * Analyzes the layer on each PE count of num_pes_list. The PE-independent part of the
+       * mapping analysis runs once; only tile counts, spatial foldings, and the buffer and
+       * performance analyses are redone per point. This analysis itself is left unchanged.
+       */
+      std::vector<LayerMetrics> SweepNumPEs(std::vector<int> num_pes_list) {
+        std::vector<LayerMetrics> ret;
+        ret.reserve(num_pes_list.size());
+
+        auto map_analysis = this->CreateMappingAnalysis();
+        try {
+          map_analysis->PreProcessMapping();
+        }
+        catch(ArithmeticOverflow& e) {
+          for(auto& num_pes : num_pes_list) {
+            LayerMetrics invalid_point;
+            invalid_point.num_pes = num_pes;
+            invalid_point.error = LayerAnalysisError::ARITHMETIC_OVERFLOW;
+            ret.push_back(invalid_point);
+          }
+          return ret;
+        }
+
+        int min_num_pes = this->GetMinNumPEs();
+
+        for(auto& num_pes : num_pes_list) {
+          if(num_pes < min_num_pes) {
+            LayerMetrics invalid_point;
+            invalid_point.num_pes = num_pes;
+            invalid_point.error = LayerAnalysisError::NOT_ENOUGH_PES;
+            ret.push_back(invalid_point);
+            continue;
+          }
+
+          map_analysis->PreProcessNumPEs(num_pes);
+
+          LayerAnalysis point = *this;
+          point.num_pes_ = num_pes;
+          point.map_analysis_ = map_analysis;
+          try {
+            point.AnalyzeCost();
+          }
+          catch(ArithmeticOverflow& e) {
+            point.Invalidate(LayerAnalysisError::ARITHMETIC_OVERFLOW);
+          }
+
+          ret.push_back(point.GetMetrics());
+        }
+
+        return ret;
+      }
+
+    protected:
+      static std::list<std::string> JoinTensors(const std::list<std::string>& input_tensors, const std::list<std::string>& output_tensors) {
+        std::list<std::string> tensors = input_tensors;
+        tensors.insert(tensors.end(), output_tensors.begin(), output_tensors.end());
+        return tensors;
+      }
+
+      std::shared_ptr<MappingAnalysis> CreateMappingAnalysis() {
+        return std::allocate_shared<MappingAnalysis>(std::pmr::polymorphic_allocator<MappingAnalysis>(resource_),
+                                                     pragma_table_, loop_info_table_, resource_);
+      }
+
+      // Buffer and performance analyses on top of a preprocessed map_analysis_
+      void AnalyzeCost() {
+        buffer_analysis_ = std::allocate_shared<BufferAnalysis>(std::pmr::polymorphic_allocator<BufferAnalysis>(resource_),
+                                                                map_analysis_, noc_model_, num_pes_);
+        buffer_analysis_->SetL2Capacity(l2_size_);
+        buffer_analysis_->SetSparsityModel(sparsity_model_);
+        buffer_analysis_->SetPrefetchDepth(prefetch_depth_);
+        buffer_analysis_->SetReductionNetworkModel(reduction_model_);
+
+        perf_analysis_ = std::allocate_shared<PerformanceAnalysis>(std::pmr::polymorphic_allocator<PerformanceAnalysis>(resource_),
+                                                                   map_analysis_, buffer_analysis_, noc_model_, do_reduction_, do_implicit_reduction_, fg_sync_);
+        perf_analysis_->SetOffChipMemoryModel(dram_model_);
+        perf_analysis_->SetSparsityModel(sparsity_model_);
+        perf_analysis_->SetDrainOverlap(drain_overlap_);
+
+        runtime_breakdown_ = RuntimeBreakdown();
+        runtime_ = perf_analysis_->GetRunTime(input_tensors_, output_tensors_, num_pes_, num_alus_per_pe_, latency_hiding_, &runtime_breakdown_);
+
+        // Evaluated here so that an overflow in any of the metrics invalidates the point
+        metrics_ = this->CollectMetrics();
+        valid_ = true;
+      }
+
+      void Invalidate(LayerAnalysisError error = LayerAnalysisError::NONE) {
+        valid_ = false;
+        runtime_ = -1;
+        runtime_breakdown_ = RuntimeBreakdown();
+        metrics_ = LayerMetrics();
+        metrics_.num_pes = num_pes_;
+        metrics_.error = error;
+      }
+
+      LayerMetrics CollectMetrics() {
+        LayerMetrics metrics;
+        metrics.num_pes = num_pes_;
+        metrics.valid = true;
+
+        metrics.runtime = runtime_;
+        metrics.energy = this->GetEnergy();
+        metrics.l1_buffer_requirement = this->GetL1BufferRequirement();
+        metrics.l2_buffer_requirement = this->GetL2BufferRequirement();
+        metrics.dram_traffic = this->GetDRAMTraffic();
+        metrics.total_ops = this->GetTotalOps();
+        metrics.num_temporal_iterations = map_analysis_->GetNumTemporalIterations();
+        metrics.num_spatial_foldings = map_analysis_->GetNumSpatialFoldings();
+        metrics.batch_size = this->GetBatchSize();
+        metrics.runtime_per_sample = this->GetRuntimePerSample();
+        metrics.energy_per_sample = this->GetEnergyPerSample();
+
+        metrics.bottleneck = runtime_breakdown_.GetBottleneck();
+
+        auto bounds = this->GetLowerBounds();
+        metrics.runtime_bound = bounds.GetRuntimeBound();
+        metrics.l2_traffic = this->GetL2Traffic();
+        metrics.l2_traffic_bound = bounds.GetL2TrafficBound();
+        if(runtime_ > 0) {
+          metrics.pe_utilization = static_cast<double>(bounds.GetEffectualTotalOps())
+                                   / (static_cast<double>(runtime_) * num_pes_ * num_alus_per_pe_);
+          metrics.noc_utilization = static_cast<double>(std::max(this->GetL2Read(), this->GetL2Write()))
+                                    / (static_cast<double>(runtime_) * noc_model_->GetBandwidth());
+        }
+
+        return metrics;
+      }
+
+    public:
+
+      const std::list<std::string>& GetInputTensors() {
+        return input_tensors_;
+      }
+
+      const std::list<std::string>& GetOutputTensors() {
+        return output_tensors_;
+      }
+
+      const std::list<std::string>& GetTensors() {
+        return tensors_;
+      }
+
+      // The smallest array that can hold one instance of every cluster in the dataflow
+      int GetMinNumPEs() {
+        return pragma_table_->GetMinNumPEs();
+      }
+
+      int GetNumPEs() {
+        return num_pes_;
+      }
+
+      bool IsValid() {
+        return valid_;
+      }
+
+      long GetRuntime() {
+        return runtime_;
+      }
+
+      // Delay components, repetitions, and bounding resource of each phase of the runtime
+      const RuntimeBreakdown& GetRuntimeBreakdown() {
+        return runtime_breakdown_;
+      }
+
+      double GetEnergy() {
+        return buffer_analysis_->GetAccessEnergy(this->GetTensors()) / mac_energy;
+      }
+
+      long GetL1BufferRequirement() {
+        return buffer_analysis_->GetL1BufferRequiredSize(this->GetTensors());
+      }
+
+      long GetL2BufferRequirement() {
+        return buffer_analysis_->GetL2BufferRequiredSize(this->GetTensors());
+      }
+
+      long GetDRAMTraffic() {
+        return buffer_analysis_->GetDRAMTraffic(input_tensors_, output_tensors_);
+      }
+
+      long GetTotalOps() {
+        return map_analysis_->GetTotalOps();
+      }
+
+      // Depends only on the layer and the hardware, so it is available before Analyze()
+      LowerBoundAnalysis GetLowerBounds() {
+        return LowerBoundAnalysis(loop_info_table_, noc_model_, dram_model_, sparsity_model_, num_pes_, num_alus_per_pe_);
+      }
+
+      long GetL2Read() {
+        long traffic = 0;
+        for(auto& tensor_name : input_tensors_) {
+          traffic = CheckedAdd(traffic, buffer_analysis_->GetL2BufferRead(tensor_name));
+        }
+        return traffic;
+      }
+
+      long GetL2Write() {
+        long traffic = 0;
+        for(auto& tensor_name : output_tensors_) {
+          traffic = CheckedAdd(traffic, buffer_analysis_->GetL1ToL2Traffic(tensor_name));
+        }
+        return traffic;
+      }
+
+      long GetL2Traffic() {
+        return CheckedAdd(this->GetL2Read(), this->GetL2Write());
+      }
+
+      int GetBatchSize() {
+        return map_analysis_->GetBatchSize();
+      }
+
+      double GetRuntimePerSample() {
+        return static_cast<double>(runtime_) / this->GetBatchSize();
+      }
+
+      double GetEnergyPerSample() {
+        return this->GetEnergy() / this->GetBatchSize();
+      }
+
+      LayerMetrics GetMetrics() {
+        return metrics_;
+      }
+
+      std::shared_ptr<SparsityModel> GetSparsityModel() {
+        return sparsity_model_;
+      }
+
+      std::shared_ptr<PragmaTable> GetPragmaTable() {
+        return pragma_table_;
+      }
+
+      std::shared_ptr<LoopInfoTable> GetLoopInfoTable() {
+        return loop_info_table_;
+      }
+
+      std::shared_ptr<MappingAnalysis> GetMapAnalysis() {
+        return map_analysis_;
+      }
+
+      std::shared_ptr<BufferAnalysis> GetBufferAnalysis() {
+        return buffer_analysis_;
+      }
+
+      std::shared_ptr<PerformanceAnalysis> GetPerfAnalysis() {
+        return perf_analysis_;
+      }
+  }; // End of class LayerAnalysis
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,231 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_LOWER_BOUND_ANALYSIS_HPP_
+#define MAESTRO_LOWER_BOUND_ANALYSIS_HPP_
+
+#include <string>
+#include <list>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "analysis-structure.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "checked-arithmetic.hpp"
+
+namespace maestro {
+
+  enum class LowerBoundResource {
+    COMPUTE,
+    NOC,
+    DRAM
+  };
+
+  /*
+   * Bounds that no mapping of a layer can beat on a given accelerator. They only depend on the
+   * layer and the hardware, so search code can compute them before analyzing a mapping and skip
+   * design points that cannot meet a target.
+   *  - Compute: every effectual operation runs on one of num_pes * num_alus_per_pe ALUs.
+   *  - NoC: every input value crosses the NoC from L2 at least once, and every output value back.
+   *  - DRAM: every input value is read from DRAM and every output value written at least once.
+   */
+  class LowerBoundAnalysis {
+    protected:
+      std::shared_ptr<LoopInfoTable> loop_info_table_;
+      std::shared_ptr<NetworkOnChipModel> noc_model_;
+      std::shared_ptr<OffChipMemoryModel> dram_model_;
+      std::shared_ptr<SparsityModel> sparsity_model_; // nullptr: every tensor is dense
+
+      std::list<std::string> input_tensors_;
+      std::list<std::string> output_tensors_;
+
+      long num_pes_;
+      long num_alus_per_pe_;
+
+      static long DivideRoundUp(long dividend, long divisor) {
+        return (divisor <= 0)? dividend : dividend / divisor + ((dividend % divisor != 0)? 1 : 0);
+      }
+
+      long GetLoopBound(std::string var) {
+        auto loop = loop_info_table_->FindLoop(var);
+        return (loop != nullptr)? loop->GetNumIter() : 1;
+      }
+
+      // Values var takes in an input; a strided loop still spans every input value
+      long GetInputBound(std::string var) {
+        auto loop = loop_info_table_->FindLoop(var);
+        return (loop != nullptr)? loop->GetExtent() : 1;
+      }
+
+      long GetOutputBound(std::string var) {
+        return loop_info_table_->GetOutputBound(var);
+      }
+
+    public:
+      LowerBoundAnalysis(std::shared_ptr<LoopInfoTable> loop_tbl, std::shared_ptr<NetworkOnChipModel> noc_model,
+                         std::shared_ptr<OffChipMemoryModel> dram_model, std::shared_ptr<SparsityModel> sparsity_model,
+                         long num_pes, long num_alus_per_pe) :
+        loop_info_table_(loop_tbl),
+        noc_model_(noc_model),
+        dram_model_(dram_model),
+        sparsity_model_(sparsity_model),
+        input_tensors_(loop_tbl->GetOperator()->GetInputTensors()),
+        output_tensors_(loop_tbl->GetOperator()->GetOutputTensors()),
+        num_pes_(num_pes),
+        num_alus_per_pe_(num_alus_per_pe)
+      {
+      }
+
+      // Multiply-accumulates of the layer, as LoopInfoTable::GetTotalOps counts them
+      long GetTotalOps() {
+        return loop_info_table_->GetTotalOps();
+      }
+
+      // Operations left after skipping the ones with a zero operand
+      long GetEffectualTotalOps() {
+        long total_ops = this->GetTotalOps();
+        if(sparsity_model_ == nullptr) return total_ops;
+
+        double fraction = sparsity_model_->GetEffectualFraction(input_tensors_);
+        return static_cast<long>(std::ceil(static_cast<double>(total_ops) * fraction));
+      }
+
+      // Values of a tensor over the entire layer; variables the layer does not have count as 1
+      long GetFullSize(std::string tensor_name) {
+        long full_size = 1;
+        for(auto& tensor : loop_info_table_->GetOperator()->GetTensorInformation()) {
+          if(tensor->GetName() != tensor_name) continue;
+
+          bool is_output = (tensor->GetClass() == TensorClass::OUTPUT);
+          for(auto& var : tensor->GetVariables()) {
+            full_size = CheckedMul(full_size, is_output? this->GetOutputBound(var) : this->GetInputBound(var));
+          }
+        }
+        return full_size;
+      }
+
+      // Bytes of a tensor as stored in buffers and DRAM
+      long GetCompulsorySize(std::string tensor_name) {
+        long full_size = this->GetFullSize(tensor_name);
+        int bits = loop_info_table_->GetTensorPrecision(tensor_name);
+        if(sparsity_model_ != nullptr) {
+          full_size = sparsity_model_->GetCompressedSize(tensor_name, full_size, bits);
+        }
+
+        return LoopInfoTable::GetBytes(full_size, bits);
+      }
+
+      // L2 to L1 reads of inputs; partial sums return to L2 dense
+      long GetL2ReadBound() {
+        long traffic = 0;
+        for(auto& tensor_name : input_tensors_) {
+          traffic = CheckedAdd(traffic, this->GetCompulsorySize(tensor_name));
+        }
+        return traffic;
+      }
+
+      long GetL2WriteBound() {
+        long traffic = 0;
+        for(auto& tensor_name : output_tensors_) {
+          traffic = CheckedAdd(traffic, LoopInfoTable::GetBytes(this->GetFullSize(tensor_name), loop_info_table_->GetTensorPrecision(tensor_name)));
+        }
+        return traffic;
+      }
+
+      long GetL2TrafficBound() {
+        return CheckedAdd(this->GetL2ReadBound(), this->GetL2WriteBound());
+      }
+
+      long GetDRAMTrafficBound() {
+        long traffic = 0;
+        for(auto& tensor_name : input_tensors_) {
+          traffic = CheckedAdd(traffic, this->GetCompulsorySize(tensor_name));
+        }
+        for(auto& tensor_name : output_tensors_) {
+          traffic = CheckedAdd(traffic, this->GetCompulsorySize(tensor_name));
+        }
+        return traffic;
+      }
+
+      // Roofs of the hardware: cycles of num_ops operations on the PE array
+      long GetComputeDelay(long num_ops) {
+        return DivideRoundUp(num_ops, CheckedMul(num_pes_, num_alus_per_pe_));
+      }
+
+      // Cycles of L2 reads and writes over the NoC, which carries both directions at once
+      long GetNoCDelay(long l2_read, long l2_write) {
+        return DivideRoundUp(std::max(l2_read, l2_write), noc_model_->GetBandwidth());
+      }
+
+      long GetDRAMDelay(long dram_traffic) {
+        if(dram_model_ == nullptr) return 0;
+
+        return dram_model_->GetStreamingDelay(dram_traffic);
+      }
+
+      static LowerBoundResource GetBindingResource(long compute_delay, long noc_delay, long dram_delay) {
+        if(dram_delay >= noc_delay && dram_delay >= compute_delay) {
+          return LowerBoundResource::DRAM;
+        }
+        else if(noc_delay >= compute_delay) {
+          return LowerBoundResource::NOC;
+        }
+        else {
+          return LowerBoundResource::COMPUTE;
+        }
+      }
+
+      long GetComputeBoundDelay() {
+        return this->GetComputeDelay(this->GetEffectualTotalOps());
+      }
+
+      long GetNoCBoundDelay() {
+        return this->GetNoCDelay(this->GetL2ReadBound(), this->GetL2WriteBound());
+      }
+
+      long GetDRAMBoundDelay() {
+        return this->GetDRAMDelay(this->GetDRAMTrafficBound());
+      }
+
+      long GetRuntimeBound() {
+        return std::max(this->GetComputeBoundDelay(), std::max(this->GetNoCBoundDelay(), this->GetDRAMBoundDelay()));
+      }
+
+      LowerBoundResource GetBindingResource() {
+        return GetBindingResource(this->GetComputeBoundDelay(), this->GetNoCBoundDelay(), this->GetDRAMBoundDelay());
+      }
+
+      std::string GetBindingResourceName() {
+        switch(this->GetBindingResource()) {
+          case LowerBoundResource::DRAM:
+            return "DRAM";
+          case LowerBoundResource::NOC:
+            return "NoC";
+          default:
+            return "Compute";
+        }
+      }
+  }; // End of class LowerBoundAnalysis
+
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+/*
+ * C interface of the MAESTRO cost model, for embedding it in design space exploration loops.
+ * A context holds one parsed dataflow and layer; hardware parameters can be changed
+ * and the context re-evaluated without parsing again.
+ */
+
+#ifndef MAESTRO_CAPI_H_
+#define MAESTRO_CAPI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAESTRO_CAPI_VERSION 6
+
+/* Status codes */
+#define MAESTRO_OK 0
+#define MAESTRO_ERROR_INVALID_ARGUMENT 1
+#define MAESTRO_ERROR_PARSE 2
+#define MAESTRO_ERROR_ANALYSIS 3
+#define MAESTRO_ERROR_OVERFLOW 4 /* A size or delay of the design point exceeds 64 bits */
+
+/* Compressed formats of sparse tensors */
+#define MAESTRO_SPARSE_FORMAT_NONE 0
+#define MAESTRO_SPARSE_FORMAT_BITMAP 1
+#define MAESTRO_SPARSE_FORMAT_RLE 2
+
+/* Reduction networks of partial sums of spatially mapped reduction variables */
+#define MAESTRO_REDUCTION_NETWORK_L2 0    /* Accumulated in L2 */
+#define MAESTRO_REDUCTION_NETWORK_TREE 1
+#define MAESTRO_REDUCTION_NETWORK_CHAIN 2
+
+typedef struct maestro_context maestro_context;
+
+typedef struct {
+  int num_pes;
+  int num_alus_per_pe;
+
+  int noc_bw;               /* Bytes per cycle */
+  int noc_hops;
+  int noc_hop_latency;
+  int noc_multicast;        /* 0: unicast only */
+
+  long l2_size;             /* Bytes; 0: unbounded L2 */
+  int dram_bw;              /* Bytes per cycle; 0: no DRAM model */
+  int dram_latency;
+
+  int sparse_format;        /* MAESTRO_SPARSE_FORMAT_* */
+
+  int do_reduction;
+  int do_implicit_reduction;
+  int latency_hiding;
+  int prefetch_depth;       /* Input tiles buffered per PE; 2: double buffering */
+  int drain_overlap;        /* 0: outputs are sent after the computation */
+
+  int reduction_network;    /* MAESTRO_REDUCTION_NETWORK_* */
+  int reduction_bw;         /* Bytes per cycle */
+  int reduction_latency;
+  double reduction_energy;  /* Per addition, in the unit of MAC energy */
+} maestro_hw_config;
+
+typedef struct {
+  long runtime;             /* cycles */
+  double energy;            /* in the unit of MAC energy */
+  long l1_buffer_requirement;
+  long l2_buffer_requirement;
+  long dram_traffic;
+  long total_ops;
+  long num_temporal_iterations;
+  long num_spatial_foldings;
+  int batch_size;
+  double runtime_per_sample;
+  double energy_per_sample;
+} maestro_metrics;
+
+int maestro_capi_version(void);
+
+/* Fills config with the defaults of the command line tool */
+void maestro_default_hw_config(maestro_hw_config* config);
+
+/*
+ * Creates a context from the text of a dataflow description and a layer description
+ * (the contents of the files under data/dataflow and data/layer).
+ * Returns NULL if either description cannot be parsed.
+ */
+maestro_context* maestro_create(const char* dataflow_text, const char* layer_text);
+void maestro_destroy(maestro_context* context);
+
+int maestro_set_hw_config(maestro_context* context, const maestro_hw_config* config);
+int maestro_get_hw_config(maestro_context* context, maestro_hw_config* config);
+
+/*
+ * Evaluates the layer on the current hardware configuration; metrics is filled on MAESTRO_OK.
+ * Returns MAESTRO_ERROR_OVERFLOW, with a runtime of -1, if a size or delay exceeds 64 bits,
+ * and MAESTRO_ERROR_ANALYSIS, also with a runtime of -1, if the dataflow needs more PEs than num_pes.
+ */
+int maestro_evaluate(maestro_context* context, maestro_metrics* metrics);
+
+/*
+ * Runtime of num_configs NoC/ALU configurations, given as one array per parameter, that share the mapping
+ * of the current configuration (its num_pes, multicast, memory, and sparsity settings).
+ * Runs on SIMD lanes when built for AVX2 or AVX-512. Invalid configurations get -1.
+ */
+int maestro_evaluate_noc_batch(maestro_context* context, long num_configs,
+                               const int* noc_bw, const int* noc_hops, const int* noc_hop_latency,
+                               const int* num_alus_per_pe, long* runtime);
+
+/*
+ * Metrics of the current configuration on each of num_points PE counts. The PE-independent part of the
+ * mapping analysis is shared by all points. PE counts too small to hold the clusters of the dataflow,
+ * and points whose sizes exceed 64-bit arithmetic, get a runtime of -1.
+ */
+int maestro_sweep_num_pes(maestro_context* context, long num_points, const int* num_pes, maestro_metrics* metrics);
+
+/* Description of the last error of the context; empty if the last call succeeded */
+const char* maestro_last_error(maestro_context* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,25 +23,41 @@ SOFTWARE.
 #include <string>
 #include <iostream>
 #include <list>
+#include <vector>
 #include <memory>
 
 #include "analysis-structure.hpp"
 #include "mapping-analysis.hpp"
 #include "cost-analysis.hpp"
+#include "option.hpp"
 
 namespace maestro {
 
   void SetNumPEs(int np);
   void SetupNoC(int bw, int hops, int hop_latency, bool mc);
+  void SetupOffChipMemory(long l2_sz, int dram_bw, int dram_latency);
+  void SetupSparsity(std::string sparse_format_name);
+  void SetupPipeline(int depth, bool overlap);
+  void SetupReductionNetwork(std::string topology_name, int bw, int latency, double add_energy);
   void SetupInputTensors(std::list<std::string>& in_tensors);
   void SetupOutputTensors(std::list<std::string>& out_tensors);
-  void ParseInputs(std::string dataflow_file_name, std::string layer_file_name);
-  void ConfigureProblem();
+  bool ParseInputs(std::string dataflow_file_name, std::string layer_file_name, std::vector<std::string> dataflow_params = {});
+  bool ConfigureProblem();
   void AnalyzeHardware();
   void AnalyzeMapping();
   void AnalyzeReuse();
   void AnalyzeBuffer(bool silent = false);
   void AnalyzeRuntime(int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true);
+  void AnalyzeRoofline(int num_alus_per_pe = 1);
+  // Report the runtime computed by AnalyzeRuntime
+  void AnalyzeEfficiency(int num_alus_per_pe = 1);
+  void AnalyzeBottleneck();
+  void WriteTrace(std::string file_name, std::string layer_name);
+  void AnalyzeNetwork(std::string network_file_name, int num_alus_per_pe = 1);
+  void AnalyzeSweep(Options& option);
+  void AnalyzePESweep(std::vector<int> num_pes_list, int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true);
+  void AnalyzeChiplets(int num_chiplets, std::string partition_var, int interchip_bw, int interchip_latency,
+                       int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true);
 
   double AnalyzeL1BuffReq_DSE();
   double AnalyzeL2BuffReq_DSE();
@@ -56,6 +72,8 @@ namespace maestro {
   std::shared_ptr<maestro::NetworkOnChipModel> GetNoCModel();
   std::shared_ptr<maestro::PerformanceAnalysis> GetPerfAnalysis();
   std::shared_ptr<maestro::MappingAnalysis> GetMapAnalysis();
+  std::shared_ptr<maestro::OffChipMemoryModel> GetOffChipMemoryModel();
+  std::shared_ptr<maestro::SparsityModel> GetSparsityModel();
 
 }; //End of namespace maestro
 
@@ -29,11 +29,13 @@ SOFTWARE.
 #include <map>
 #include <tuple>
 #include <algorithm>
+#include <memory_resource>
 
 #include "mapping-syntax.hpp"
 #include "program-syntax.hpp"
 #include "noc-model.hpp"
 #include "analysis-structure.hpp"
+#include "checked-arithmetic.hpp"
 
 namespace maestro{
 
@@ -42,19 +44,80 @@ namespace maestro{
 
 
     public:
-      MappingAnalysis(std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl) :
+      // The per-variable tables are allocated from resource (e.g., an EvaluationArena)
+      MappingAnalysis(std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
         pragma_table_(prag_tbl),
         loop_info_table_(loop_tbl),
-        num_edge_tiles_(0)
+        num_tiles_(resource),
+        spatial_map_points_(resource),
+        spatial_foldings_(resource),
+        num_edge_tiles_(0),
+        num_temporal_iterations_(resource),
+        is_unrolled_(resource),
+        is_merged_(resource),
+        mapped_elements_(resource),
+        sp_mapped_unique_elements_(resource),
+        tp_mapped_unique_elements_(resource),
+        sp_mapped_reused_elements_(resource),
+        tp_mapped_reused_elements_(resource),
+        footprint_mapped_elements_(resource),
+        footprint_sp_mapped_unique_elements_(resource),
+        footprint_tp_mapped_unique_elements_(resource),
+        footprint_tensors_(resource),
+        tensor_variables_(resource)
       {
+        CompleteLoopNest();
+        ConfigureOperator(loop_info_table_->GetOperator());
+      }
+
+      // Registers every tensor of the operator
+      void ConfigureOperator(std::shared_ptr<OperatorInformation> operator_info) {
+        operator_info_ = operator_info;
+
+        footprint_tensors_.clear();
+        for(auto& tensor : operator_info->GetTensorInformation()) {
+          this->AddTensor(tensor->GetName(), tensor->GetVariables());
+
+          auto& vars = tensor->GetVariables();
+          for(auto& window : loop_info_table_->GetSlidingWindows()) {
+            bool has_var = std::find(vars.begin(), vars.end(), window.first) != vars.end();
+            bool has_filter_var = std::find(vars.begin(), vars.end(), window.second.GetFilterVariable()) != vars.end();
+            if(tensor->GetClass() == TensorClass::INPUT && has_var && !has_filter_var) {
+              footprint_tensors_.push_back(tensor->GetName());
+              break;
+            }
+          }
+        }
+      }
+
+      // Input tensors a filter window slides over; their tiles span the window footprint
+      bool IsFootprintTensor(const std::string& tensor_name) {
+        return std::find(footprint_tensors_.begin(), footprint_tensors_.end(), tensor_name) != footprint_tensors_.end();
+      }
+
+      std::shared_ptr<OperatorInformation> GetOperator() {
+        return operator_info_;
       }
 
       void PreProcess(int num_pes) {
+        PreProcessMapping();
+        PreProcessNumPEs(num_pes);
+      }
+
+      // Analyses that only depend on the dataflow and the layer; run once per mapping
+      void PreProcessMapping() {
         AnalyzeSpatialMapPoints();
-        AnalyzeNumTiles(num_pes);
         AnalyzeTemporalIterations();
         AnalyzeUnrollMerge();
         AnalyzeMapSizes(); // Need to call AnalyzeUnrollMerge frist
+        AnalyzeSlidingWindows();
+      }
+
+      // Tile counts, spatial foldings, and edge tiles; can be re-run for another PE count
+      void PreProcessNumPEs(int num_pes) {
+        spatial_foldings_.clear();
+        AnalyzeNumTiles(num_pes);
         AnalyzeSpatialFoldings();
       }
 
@@ -78,35 +141,50 @@ namespace maestro{
 
       	sp_mapped_reused_elements_.clear();
       	tp_mapped_reused_elements_.clear();
+
+      	footprint_mapped_elements_.clear();
+      	footprint_sp_mapped_unique_elements_.clear();
+      	footprint_tp_mapped_unique_elements_.clear();
       }
 
       void AddTensor(std::string tensor_name, std::list<std::string> variable_list) {
-        tensor_variables_[tensor_name] = variable_list;
+        auto& tensor_vars = tensor_variables_[tensor_name];
+        tensor_vars.assign(variable_list.begin(), variable_list.end());
       }
 
-      long GetMappedSize(std::string tensor_name, bool temporal_reuse, bool spatial_reuse) {
+      /*
+       * Without window_footprint, the sizes of input tensors a filter slides over are counted
+       * in window positions, as at stride 1, instead of in the input values the tile spans
+       */
+      long GetMappedSize(std::string tensor_name, bool temporal_reuse, bool spatial_reuse, bool window_footprint = true) {
         long ret = 1;
 
         auto sp_map_var= this->GetSpMapVariable();
         int sp_map_size = this->GetSpVarMapSz();
+        bool is_footprint_tensor = window_footprint && this->IsFootprintTensor(tensor_name);
 
         for(auto& var : tensor_variables_[tensor_name]) {
-          int mult = 1;
+          long mult = 1;
           bool is_var_correlated_sp_map = this->HasVariable(tensor_name, sp_map_var) && this->HasVariable(tensor_name, var);
-          auto cls = pragma_table_->FindPragma(var)->front()->GetClass();
+          auto cls = pragma_table_->GetPragma(pragma_table_->FindPragmaPos(var)).GetClass();
+
+          bool has_footprint = is_footprint_tensor && footprint_mapped_elements_.find(var) != footprint_mapped_elements_.end();
+          auto& mapped_elements = has_footprint? footprint_mapped_elements_ : mapped_elements_;
+          auto& sp_mapped_unique_elements = has_footprint? footprint_sp_mapped_unique_elements_ : sp_mapped_unique_elements_;
+          auto& tp_mapped_unique_elements = has_footprint? footprint_tp_mapped_unique_elements_ : tp_mapped_unique_elements_;
 
           if(temporal_reuse && spatial_reuse) {
             switch(cls) {
               case PragmaClass::TEMPORAL_MAP : {
-                mult = tp_mapped_unique_elements_[var];
+                mult = tp_mapped_unique_elements[var];
                 break;
               }
               case PragmaClass::SPATIAL_MAP : {
-                mult = sp_mapped_unique_elements_[var];
+                mult = sp_mapped_unique_elements[var];
                 break;
               }
               case PragmaClass::UNROLL : {
-                mult = tp_mapped_unique_elements_[var];
+                mult = tp_mapped_unique_elements[var];
                 break;
               }
               default:
@@ -114,43 +192,43 @@ namespace maestro{
             }
           }
           else if (temporal_reuse && !spatial_reuse) {
-            mult = tp_mapped_unique_elements_[var];
+            mult = tp_mapped_unique_elements[var];
           }
           else if (!temporal_reuse && spatial_reuse) {
-            mult = sp_mapped_unique_elements_[var];
+            mult = sp_mapped_unique_elements[var];
           }
           else {
-            mult = mapped_elements_[var];
+            mult = mapped_elements[var];
           }
 
 //          if(mult == 0) mult = 1;
 
-          ret *= mult;
+          ret = CheckedMul(ret, mult);
         }
 
         return ret;
       }
 
 
-      int GetSpMappedSize(std::string tensor_name, bool enable_spatial_reuse = false) {
-        int ret = 1;
+      long GetSpMappedSize(std::string tensor_name, bool enable_spatial_reuse = false) {
+        long ret = 1;
 
-        auto var_list = tensor_variables_[tensor_name];
+        auto& var_list = tensor_variables_[tensor_name];
         for(auto& var : var_list) {
-          int mult = enable_spatial_reuse? sp_mapped_unique_elements_[var] : mapped_elements_[var];
-          ret *= mult;
+          long mult = enable_spatial_reuse? sp_mapped_unique_elements_[var] : mapped_elements_[var];
+          ret = CheckedMul(ret, mult);
         }
 
         return ret;
       }
 
-      int GetTpMappedSize(std::string tensor_name, bool enable_temporal_reuse = false) {
-        int ret = 1;
+      long GetTpMappedSize(std::string tensor_name, bool enable_temporal_reuse = false) {
+        long ret = 1;
 
-        auto var_list = tensor_variables_[tensor_name];
+        auto& var_list = tensor_variables_[tensor_name];
         for(auto& var : var_list) {
-          int mult = enable_temporal_reuse? tp_mapped_unique_elements_[var] : mapped_elements_[var];
-          ret *= mult;
+          long mult = enable_temporal_reuse? tp_mapped_unique_elements_[var] : mapped_elements_[var];
+          ret = CheckedMul(ret, mult);
         }
 
         return ret;
@@ -159,7 +237,7 @@ namespace maestro{
       bool HasVariable(std::string tensor_name, std::string var_name) {
         bool ret = false;
 
-        auto var_list = tensor_variables_[tensor_name];
+        auto& var_list = tensor_variables_[tensor_name];
         for(auto& var : var_list) {
           if(var_name == var) ret =true;
         }
@@ -170,9 +248,9 @@ namespace maestro{
       std::string GetSpMapVariable() {
         std::string ret = "";
 
-        for(auto& pragma : *pragma_table_) {
-          if(pragma->GetClass() == PragmaClass::SPATIAL_MAP) {
-            ret = pragma->GetVarName();
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::SPATIAL_MAP) {
+            ret = pragma.GetVarName();
           }
         }
 
@@ -182,9 +260,9 @@ namespace maestro{
       int GetSpVarMapSz() {
         int ret = 1;
 
-        for(auto& pragma : *pragma_table_) {
-          if(pragma->GetClass() == PragmaClass::SPATIAL_MAP) {
-            ret = pragma->GetSize();
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::SPATIAL_MAP) {
+            ret = pragma.GetSize();
           }
         }
 
@@ -193,12 +271,13 @@ namespace maestro{
 
       long GetFullSize(std::string tensor_name) {
         long full_size = 1;
-        auto targ_tensor_vars = tensor_variables_[tensor_name];
+        auto& targ_tensor_vars = tensor_variables_[tensor_name];
         for(auto& var_name : targ_tensor_vars) {
-          auto corr_loop_list = loop_info_table_->FindLoops(var_name);
+          auto corr_loop = loop_info_table_->FindLoop(var_name);
           //TODO: Extend it to general loop nest cases
 
-          full_size *= static_cast<long>(corr_loop_list->front()->GetNumIter());
+          bool has_footprint = this->IsFootprintTensor(tensor_name) && loop_info_table_->FindSlidingWindow(var_name) != nullptr;
+          full_size = CheckedMul(full_size, has_footprint? corr_loop->GetExtent() : corr_loop->GetNumIter());
         }
 
         return full_size;
@@ -208,11 +287,10 @@ namespace maestro{
 
       	int loop_bound = -1;
 
-        for(auto& prag : *pragma_table_) {
-          auto loop_var = prag->GetVarName();
+        for(auto prag : *pragma_table_) {
+          auto loop_var = prag.GetVarName();
           if(loop_var == var_name) {
-          	auto corresponding_loops = loop_info_table_->FindLoops(loop_var);
-          	auto target_loop = corresponding_loops->front();
+          	auto target_loop = loop_info_table_->FindLoop(loop_var);
           	loop_bound = target_loop->GetNumIter();
           }
         }
@@ -220,33 +298,29 @@ namespace maestro{
         return loop_bound;
       }
 
+      // Switches this analysis to a new version of the pragma table; the caller's table is not modified
       void SetMapSize(std::string var_name, int size, int ofs, PragmaClass targPragmaClass) {
+        auto new_pragma_table = pragma_table_;
 
       	int pos = 0;
         for(auto prag : *pragma_table_) {
-          auto loop_var = prag->GetVarName();
-
-          if(loop_var == var_name && (prag->GetClass() == PragmaClass::TEMPORAL_MAP || prag->GetClass() == PragmaClass::SPATIAL_MAP)) {
-          	switch(targPragmaClass) {
-							case PragmaClass::TEMPORAL_MAP: {
-								auto new_prag = std::make_shared<TemporalMap>(var_name, size, ofs);
-								pragma_table_->SetPragma(new_prag, pos);
-								break;
-							}
-							case PragmaClass::SPATIAL_MAP: {
-								auto new_prag = std::make_shared<SpatialMap>(var_name, size, ofs);
-								pragma_table_->SetPragma(new_prag, pos);
-								break;
-							}
-							default: {
-								// Do nothing
-							}
+          auto loop_var = prag.GetVarName();
+
+          if(loop_var == var_name && (prag.GetClass() == PragmaClass::TEMPORAL_MAP || prag.GetClass() == PragmaClass::SPATIAL_MAP)) {
+          	if(targPragmaClass == PragmaClass::TEMPORAL_MAP || targPragmaClass == PragmaClass::SPATIAL_MAP) {
+          	  PragmaEntry new_entry;
+          	  new_entry.cls = targPragmaClass;
+          	  new_entry.var_id = prag.GetVarId();
+          	  new_entry.size = size;
+          	  new_entry.offset = ofs;
+          	  new_pragma_table = new_pragma_table->WithPragma(new_entry, pos);
           	}
           }
 
           pos++;
         }
 
+        pragma_table_ = new_pragma_table;
       }
 
 
@@ -268,19 +342,19 @@ namespace maestro{
           int prag_id = 0;
           bool saw_related_value = false;
 
-          for(auto& prag : *pragma_table_) {
-            auto loopvar = prag->GetVarName();
+          for(auto prag : *pragma_table_) {
+            auto loopvar = prag.GetVarName();
 
             if(this->HasVariable(target_tensor, loopvar)) {
               saw_related_value = true;
             }
             else if(prag_id < sp_map_prag_id && saw_related_value ) {
-              auto loop_info = loop_info_table_->FindLoops(loopvar)->front();
-//                mult2.push_back((prag->GetClass() == PragmaClass::UNROLL)? 1 : loop_info->GetNumIter()/prag->GetOffset());
-              int test_zero = loop_info->GetNumIter()/prag->GetSize();
+              auto loop_info = loop_info_table_->FindLoop(loopvar);
+//                mult2.push_back((prag.GetClass() == PragmaClass::UNROLL)? 1 : loop_info->GetNumIter()/prag.GetOffset());
+              int test_zero = loop_info->GetNumIter()/prag.GetSize();
               test_zero = (test_zero == 0)? 1 : test_zero;
-                mult *= (prag->GetClass() == PragmaClass::UNROLL)? 1 : test_zero;
-//                std::cout << "LoopVar: " << loopvar << ", Num iter: " << loop_info->GetNumIter() << ", Size: " <<  prag->GetSize() << ", Offset: " << prag->GetOffset() << ", mult: " << mult << std::endl;
+                mult = CheckedMul(mult, (prag.GetClass() == PragmaClass::UNROLL)? 1 : test_zero);
+//                std::cout << "LoopVar: " << loopvar << ", Num iter: " << loop_info->GetNumIter() << ", Size: " <<  prag.GetSize() << ", Offset: " << prag.GetOffset() << ", mult: " << mult << std::endl;
             }
             prag_id++;
           }
@@ -292,8 +366,8 @@ namespace maestro{
       }
 
 
-      std::list<std::tuple<std::string, int>> GetNumSpatialTiles() {
-        std::list<std::tuple<std::string, int>> num_spatial_tiles;
+      std::list<std::tuple<std::string, long>> GetNumSpatialTiles() {
+        std::list<std::tuple<std::string, long>> num_spatial_tiles;
 
         for(auto& sMapPoint : spatial_map_points_) {
           auto sMapLoopVar = std::get<0>(sMapPoint);
@@ -303,16 +377,16 @@ namespace maestro{
         return num_spatial_tiles;
       }
 
-      int GetNumEdgeTiles() {
+      long GetNumEdgeTiles() {
         return num_edge_tiles_;
       }
 
-      int GetNumTemporalIterations() {
+      long GetNumTemporalIterations() {
         //TODO: Extend it for multi-level spatial mapping cases
         return num_temporal_iterations_.front();
       }
 
-      int GetNumSpatialFoldings () {
+      long GetNumSpatialFoldings () {
         auto sp_fold_info = spatial_foldings_.front();
         return std::get<1>(sp_fold_info);
       }
@@ -321,25 +395,66 @@ namespace maestro{
       	return loop_info_table_->GetTotalIterations();
       }
 
+      long GetTotalOps() {
+        return loop_info_table_->GetTotalOps();
+      }
+
+      bool HasLoop(std::string var_name) {
+        return loop_info_table_->FindLoop(var_name) != nullptr;
+      }
+
+      int GetBatchSize() {
+        auto batch_var = operator_info_->GetBatchVariable();
+        if(batch_var.empty() || !this->HasLoop(batch_var)) return 1;
+
+        return loop_info_table_->FindLoop(batch_var)->GetNumIter();
+      }
+
+      // Operations in the iteration space mapped on a PE at a time: the product of mapped sizes of every operator variable
+      long GetMappedIterations() {
+        long ret = 1;
+
+        for(auto& var : operator_info_->GetIterationVariables()) {
+          ret = CheckedMul(ret, mapped_elements_[var]);
+        }
+
+        return ret;
+      }
+
+      std::shared_ptr<PragmaTable> GetPragmaTable() {
+        return pragma_table_;
+      }
+
+      std::shared_ptr<LoopInfoTable> GetLoopInfoTable() {
+        return loop_info_table_;
+      }
+
     protected:
       std::shared_ptr<PragmaTable> pragma_table_;
       std::shared_ptr<LoopInfoTable> loop_info_table_;
+      std::shared_ptr<OperatorInformation> operator_info_;
 
-      std::map<std::string, int> num_tiles_;
-      std::list<std::tuple<std::string, int>> spatial_map_points_;
-      std::list<std::tuple<std::string, int>> spatial_foldings_;
+      std::pmr::map<std::string, long> num_tiles_;
+      std::pmr::list<std::tuple<std::string, int>> spatial_map_points_;
+      std::pmr::list<std::tuple<std::string, long>> spatial_foldings_;
 
-      int num_edge_tiles_;
+      long num_edge_tiles_;
 
-      std::vector<int> num_temporal_iterations_;
-      std::map<std::string, bool> is_unrolled_; //Unroll
-      std::map<std::string, bool> is_merged_; //Merge
-      std::map<std::string, int> mapped_elements_; //TSz
-      std::map<std::string, int> sp_mapped_unique_elements_; //TUSz
-      std::map<std::string, int> tp_mapped_unique_elements_; //TUSz
+      std::pmr::vector<long> num_temporal_iterations_;
+      std::pmr::map<std::string, bool> is_unrolled_; //Unroll
+      std::pmr::map<std::string, bool> is_merged_; //Merge
+      std::pmr::map<std::string, long> mapped_elements_; //TSz
+      std::pmr::map<std::string, long> sp_mapped_unique_elements_; //TUSz
+      std::pmr::map<std::string, long> tp_mapped_unique_elements_; //TUSz
 
-      std::map<std::string, int> sp_mapped_reused_elements_; //
-      std::map<std::string, int> tp_mapped_reused_elements_; //
+      std::pmr::map<std::string, long> sp_mapped_reused_elements_; //
+      std::pmr::map<std::string, long> tp_mapped_reused_elements_; //
+
+      // Input values spanned by the tiles of variables a filter slides over, with the halo
+      std::pmr::map<std::string, long> footprint_mapped_elements_;
+      std::pmr::map<std::string, long> footprint_sp_mapped_unique_elements_;
+      std::pmr::map<std::string, long> footprint_tp_mapped_unique_elements_;
+      std::pmr::list<std::string> footprint_tensors_;
 
       /* One invaraint
        *
@@ -348,16 +463,65 @@ namespace maestro{
        * */
 
 
-      std::map<std::string, std::list<std::string>> tensor_variables_;
+      std::pmr::map<std::string, std::pmr::list<std::string>> tensor_variables_;
 
     private:
 
+      /*
+       * A dataflow does not need to mention every loop of a layer (e.g., the batch loop N).
+       * Loops without a pragma are iterated outermost, one value at a time, and pragmas on
+       * variables the layer does not have map a loop of bound 1. The caller's tables are left untouched.
+       */
+      void CompleteLoopNest() {
+        std::list<std::string> unmapped_vars;
+        for(auto& loop : *loop_info_table_) {
+          if(pragma_table_->FindPragmaPos(loop->GetLoopVar()) < 0) {
+            unmapped_vars.push_back(loop->GetLoopVar());
+          }
+        }
+
+        std::list<std::string> unbound_vars;
+        for(auto pragma : *pragma_table_) {
+          auto loop_var = pragma.GetVarName();
+          if(pragma.GetClass() != PragmaClass::TILE && loop_info_table_->FindLoop(loop_var) == nullptr
+              && std::find(unbound_vars.begin(), unbound_vars.end(), loop_var) == unbound_vars.end()) {
+            unbound_vars.push_back(loop_var);
+          }
+        }
+
+        if(!unmapped_vars.empty()) {
+          auto completed_pragma_table = std::make_shared<PragmaTable>();
+          for(auto& var : unmapped_vars) {
+            completed_pragma_table->AddPragma(std::make_shared<TemporalMap>(var, 1, 1));
+          }
+          for(auto pragma : *pragma_table_) {
+            completed_pragma_table->AddPragma(pragma);
+          }
+          pragma_table_ = completed_pragma_table;
+        }
+
+        if(!unbound_vars.empty()) {
+          auto completed_loop_table = std::make_shared<LoopInfoTable>();
+          completed_loop_table->SetOperator(loop_info_table_->GetOperator());
+          completed_loop_table->SetTensorDensities(loop_info_table_->GetTensorDensities());
+          completed_loop_table->SetTensorPrecisions(loop_info_table_->GetTensorPrecisions(), loop_info_table_->GetPartialSumPrecisions());
+          completed_loop_table->SetSlidingWindows(loop_info_table_->GetSlidingWindows());
+          for(auto& loop : *loop_info_table_) {
+            completed_loop_table->AddLoop(loop);
+          }
+          for(auto& var : unbound_vars) {
+            completed_loop_table->AddLoop(std::make_shared<LoopInformation>(var, 0, 1));
+          }
+          loop_info_table_ = completed_loop_table;
+        }
+      }
+
       void AnalyzeSpatialMapPoints() {
         int pragma_id = 0;
-        for(auto& pragma : *pragma_table_) {
-          if(pragma->GetClass() == PragmaClass::SPATIAL_MAP) {
-//          	std::cout << "SMAP size: " << pragma->GetSize() << ", Offset: " << pragma->GetOffset() << std::endl;
-            spatial_map_points_.push_back({pragma->GetVarName(), pragma_id});
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::SPATIAL_MAP) {
+//          	std::cout << "SMAP size: " << pragma.GetSize() << ", Offset: " << pragma.GetOffset() << std::endl;
+            spatial_map_points_.push_back({pragma.GetVarName(), pragma_id});
           }
           pragma_id++;
         }
@@ -365,31 +529,30 @@ namespace maestro{
 
       void AnalyzeSpatialFoldings() {
 
-        for(auto& pragma : *pragma_table_) {
-          if(pragma->GetClass() == PragmaClass::SPATIAL_MAP) {
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::SPATIAL_MAP) {
 
-            auto loop_var = pragma->GetVarName();
-            int ofs = pragma->GetOffset();
+            auto loop_var = pragma.GetVarName();
+            int ofs = pragma.GetOffset();
 
-            auto corresponding_loops = loop_info_table_->FindLoops(loop_var);
             //TODO:Extend it for general cases
-            auto loop_info = corresponding_loops->front();
+            auto loop_info = loop_info_table_->FindLoop(loop_var);
             auto loop_sz = loop_info->GetNumIter();
 
             auto sp_tile_info = this->GetNumSpatialTiles();
             //TODO: Extend it to multi-level spatial map
-            int num_sp_tiles = std::get<1>(sp_tile_info.front());
+            long num_sp_tiles = std::get<1>(sp_tile_info.front());
 
 //            std::cout << "num_sp_tiles: " << num_sp_tiles << std::endl;
 
-            int num_spatial_foldings = loop_sz / ofs / num_sp_tiles;
+            long num_spatial_foldings = loop_sz / ofs / num_sp_tiles;
             if(num_spatial_foldings == 0) {
               num_spatial_foldings = 1;
             }
 
             num_edge_tiles_ = (loop_sz / ofs) % num_sp_tiles;
             if(num_edge_tiles_ == 0) num_edge_tiles_ = num_sp_tiles;
-            spatial_foldings_.push_back({pragma->GetVarName(), num_spatial_foldings});
+            spatial_foldings_.push_back({pragma.GetVarName(), num_spatial_foldings});
           }
         }
 
@@ -397,33 +560,33 @@ namespace maestro{
 
       void AnalyzeUnrollMerge() {
 
-        for(auto& pragma : *pragma_table_) {
-          auto loop_var = pragma->GetVarName();
+        for(auto pragma : *pragma_table_) {
+          auto loop_var = pragma.GetVarName();
           is_unrolled_[loop_var] = false;
           is_merged_[loop_var] = false;
         }
 
-        for(auto& pragma : *pragma_table_) {
-          auto loop_var = pragma->GetVarName();
+        for(auto pragma : *pragma_table_) {
+          auto loop_var = pragma.GetVarName();
 
-          if(pragma->GetClass() == PragmaClass::UNROLL) {
+          if(pragma.GetClass() == PragmaClass::UNROLL) {
             is_unrolled_[loop_var] = true;
           }
-          if(pragma->GetClass() == PragmaClass::MERGE) {
+          if(pragma.GetClass() == PragmaClass::MERGE) {
             is_merged_[loop_var] = true;
           }
         }
       }
 
       void AnalyzeNumTiles(int num_pes) {
-        int curr_num_tiles = num_pes;
+        long curr_num_tiles = num_pes;
 
-        for(auto& pragma : *pragma_table_) {
-          if(pragma->GetClass() == PragmaClass::TILE) {
-            curr_num_tiles = curr_num_tiles / pragma->GetSize();
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::TILE) {
+            curr_num_tiles = curr_num_tiles / pragma.GetSize();
           }
-          num_tiles_[pragma->GetVarName()] = curr_num_tiles;
-//            std::cout << "NumTiles[" << pragma->GetVarName() << "] = " << curr_num_tiles << std::endl;
+          num_tiles_[pragma.GetVarName()] = curr_num_tiles;
+//            std::cout << "NumTiles[" << pragma.GetVarName() << "] = " << curr_num_tiles << std::endl;
         }
       }
 
@@ -437,21 +600,21 @@ namespace maestro{
 
           curr_bound = pragma_table_->GetPragmaCounts(); //TODO
 
-          int num_temp_iter = 1;
+          long num_temp_iter = 1;
 
           for(int prag_id = curr_base; prag_id < curr_bound; prag_id++) {
             auto targ_pragma = pragma_table_->GetPragma(prag_id);
-            if(targ_pragma->GetClass() != PragmaClass::TILE && targ_pragma->GetClass() != PragmaClass::SPATIAL_MAP) {
-              auto match_loop_list = loop_info_table_->FindLoops(pragma_table_->GetPragma(prag_id)->GetVarName());
-              int ofs = targ_pragma->GetOffset();
+            if(targ_pragma.GetClass() != PragmaClass::TILE && targ_pragma.GetClass() != PragmaClass::SPATIAL_MAP) {
+              auto match_loop_list = loop_info_table_->FindLoops(targ_pragma.GetVarName());
+              int ofs = targ_pragma.GetOffset();
               for(auto& loop : *match_loop_list) {
                 //TODO: Extend it to general loop nest cases
                 //if(loop_block_id matches)
-                if(targ_pragma->GetClass() != PragmaClass::UNROLL) {  //TODO
+                if(targ_pragma.GetClass() != PragmaClass::UNROLL) {  //TODO
                   int mult = (loop->GetNumIter()/ofs);
                   mult = (mult == 0)? 1 : mult;
-                  num_temp_iter *= mult;
-//                  std::cout << "For pragma " << targ_pragma->ToString() << ", temp it size = " << mult <<std::endl;
+                  num_temp_iter = CheckedMul(num_temp_iter, mult);
+//                  std::cout << "For pragma " << targ_pragma.ToString() << ", temp it size = " << mult <<std::endl;
                 }  //TODO
               }
             }
@@ -464,15 +627,14 @@ namespace maestro{
       }
 
       void AnalyzeMapSizes() {
-        for(auto& prag : *pragma_table_) {
-          auto prag_class = prag->GetClass();
-          int map_size = prag->GetSize();
-          int offset = prag->GetOffset();
+        for(auto prag : *pragma_table_) {
+          auto prag_class = prag.GetClass();
+          int map_size = prag.GetSize();
+          int offset = prag.GetOffset();
 
-          auto loop_var = prag->GetVarName();
-          auto corresponding_loops = loop_info_table_->FindLoops(loop_var);
+          auto loop_var = prag.GetVarName();
           //TODO: Extend it to generael case; non-perfectly-nested loop case
-          auto target_loop = corresponding_loops->front();
+          auto target_loop = loop_info_table_->FindLoop(loop_var);
           int loop_size = target_loop->GetNumIter();
 
           switch(prag_class) {
@@ -528,6 +690,62 @@ namespace maestro{
         } // End of for(prag : pragma_table)
       } // End of  function AnalyzeMapSizes
 
+      /*
+       * Map sizes and offsets of a variable a filter slides over are in window positions.
+       * A tile spans the footprint of its windows, and neighbouring tiles (spatially or
+       * temporally) start offset * stride values apart; the rest of the footprint is the
+       * halo they share, which is reused instead of being sent again.
+       */
+      void AnalyzeSlidingWindows() {
+        for(auto& window_info : loop_info_table_->GetSlidingWindows()) {
+          auto var = window_info.first;
+          auto window = window_info.second;
+
+          // The map that sets the mapped sizes of var in AnalyzeMapSizes, not a cluster on var
+          int prag_pos = -1;
+          int pos = 0;
+          for(auto prag : *pragma_table_) {
+            auto cls = prag.GetClass();
+            if(prag.GetVarName() == var && (cls == PragmaClass::TEMPORAL_MAP || cls == PragmaClass::SPATIAL_MAP || cls == PragmaClass::UNROLL)) {
+              prag_pos = pos;
+            }
+            pos++;
+          }
+          if(prag_pos < 0 || mapped_elements_.find(var) == mapped_elements_.end()) continue;
+          auto prag = pragma_table_->GetPragma(prag_pos);
+
+          auto filter_elements = mapped_elements_.find(window.GetFilterVariable());
+          long num_filter_values = (filter_elements != mapped_elements_.end())? filter_elements->second : 1;
+
+          long footprint = window.GetFootprint(mapped_elements_[var], num_filter_values);
+          long unique_elements = std::min(footprint, CheckedMul(static_cast<long>(prag.GetOffset()), window.GetStride()));
+
+          footprint_mapped_elements_[var] = footprint;
+          switch(prag.GetClass()) {
+            case PragmaClass::TEMPORAL_MAP: {
+              footprint_tp_mapped_unique_elements_[var] = unique_elements;
+              footprint_sp_mapped_unique_elements_[var] = footprint;
+              break;
+            }
+            case PragmaClass::SPATIAL_MAP: {
+              footprint_tp_mapped_unique_elements_[var] = footprint;
+              footprint_sp_mapped_unique_elements_[var] = unique_elements;
+              break;
+            }
+            case PragmaClass::UNROLL: {
+              footprint_tp_mapped_unique_elements_[var] = footprint;
+              footprint_sp_mapped_unique_elements_[var] = 1;
+              break;
+            }
+            default: {
+              footprint_tp_mapped_unique_elements_[var] = footprint;
+              footprint_sp_mapped_unique_elements_[var] = footprint;
+              break;
+            }
+          }
+        }
+      } // End of function AnalyzeSlidingWindows
+
 
   }; // End of class MappingAnalysis
 }; // End of namespace maestro
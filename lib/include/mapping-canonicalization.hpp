@@ -0,0 +1,123 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_MAPPING_CANONICALIZATION_HPP_
+#define MAESTRO_MAPPING_CANONICALIZATION_HPP_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "mapping-syntax.hpp"
+#include "analysis-structure.hpp"
+
+namespace maestro {
+
+  /*
+   * Whether the analysis steps through the directive at once: unroll, and temporal maps
+   * whose size covers their loop (loop bound / size <= 1). Such directives never scale how
+   * often the tensors of the directives after them change, so their order within a run
+   * of them does not matter.
+   */
+  inline bool IsSingleStepDirective(const PragmaView& pragma, std::shared_ptr<LoopInfoTable> loop_tbl) {
+    if(pragma.GetClass() == PragmaClass::UNROLL) return true;
+    if(pragma.GetClass() != PragmaClass::TEMPORAL_MAP || pragma.GetSize() <= 0) return false;
+
+    auto loop = loop_tbl->FindLoop(pragma.GetVarName());
+    int loop_bound = (loop != nullptr)? loop->GetNumIter() : 1;
+    return loop_bound / pragma.GetSize() <= 1;
+  }
+
+  /*
+   * The canonical form of a dataflow on a layer. Many pragma tables lead to the same
+   * analysis; they all have the same canonical form:
+   *  - Loops that the dataflow does not mention are mapped with Temporal_Map (1,1) at the
+   *    front, as MappingAnalysis does, so leaving out a loop of bound 1 and mapping it with
+   *    Temporal_Map (1,1) among the first directives are the same.
+   *  - Runs of adjacent single-step directives are sorted by variable.
+   *  - The offset of a temporal map beyond its loop and its size, which only ever takes one
+   *    step, becomes the larger of the two.
+   * Analyzing the canonical table gives the same results as analyzing the original.
+   */
+  inline std::shared_ptr<PragmaTable> CanonicalizeMapping(std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl) {
+    auto completed_table = std::make_shared<PragmaTable>();
+    for(auto& loop : *loop_tbl) {
+      if(prag_tbl->FindPragmaPos(loop->GetLoopVar()) < 0) {
+        completed_table->AddPragma(std::make_shared<TemporalMap>(loop->GetLoopVar(), 1, 1));
+      }
+    }
+    for(auto pragma : *prag_tbl) {
+      completed_table->AddPragma(pragma);
+    }
+
+    int num_pragmas = completed_table->GetPragmaCounts();
+    std::vector<int> order(num_pragmas);
+    for(int pos = 0; pos < num_pragmas; pos++) {
+      order[pos] = pos;
+    }
+
+    int run_begin = 0;
+    while(run_begin < num_pragmas) {
+      int run_end = run_begin;
+      while(run_end < num_pragmas && IsSingleStepDirective(completed_table->GetPragma(run_end), loop_tbl)) {
+        run_end++;
+      }
+
+      // A stable sort keeps the order of directives on the same variable
+      std::stable_sort(order.begin() + run_begin, order.begin() + run_end, [&](int lhs, int rhs) {
+        return completed_table->GetPragma(lhs).GetVarName() < completed_table->GetPragma(rhs).GetVarName();
+      });
+      run_begin = run_end + 1;
+    }
+
+    auto canonical_table = std::make_shared<PragmaTable>();
+    for(auto pos : order) {
+      canonical_table->AddPragma(completed_table->GetPragma(pos));
+    }
+
+    auto entries = canonical_table->GetEntries();
+    for(int pos = 0; pos < num_pragmas; pos++) {
+      auto& entry = entries[pos];
+      if(entry.cls != PragmaClass::TEMPORAL_MAP) continue;
+
+      auto loop = loop_tbl->FindLoop(canonical_table->GetPragma(pos).GetVarName());
+      int loop_bound = (loop != nullptr)? loop->GetNumIter() : 1;
+      if(entry.offset >= loop_bound && entry.offset > entry.size) {
+        entry.offset = std::max(entry.size, loop_bound);
+      }
+    }
+
+    return canonical_table->WithEntries(std::move(entries));
+  }
+
+  // A key that is equal for two tables exactly when they hold the same directives
+  inline std::string GetMappingKey(const PragmaTable& prag_tbl) {
+    std::string key;
+    for(auto pragma : prag_tbl) {
+      key += std::to_string(static_cast<int>(pragma.GetClass())) + ' ' + pragma.GetVarName() + ' '
+             + std::to_string(pragma.GetSize()) + ' ' + std::to_string(pragma.GetOffset()) + ' '
+             + std::to_string(pragma.GetNumSpatialComponents()) + ';';
+    }
+    return key;
+  }
+
+}; // End of namespace maestro
+
+#endif
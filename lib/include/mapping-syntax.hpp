@@ -22,6 +22,8 @@ SOFTWARE.
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <memory>
 
 #include<boost/format.hpp>
 
@@ -44,6 +46,7 @@ namespace maestro {
   const std::string tkn_unroll = "unroll";
   const std::string tkn_merge = "merge";
   const std::string tkn_tile = "Cluster";
+  const std::string tkn_loop_size = "Sz";
   const std::string tkn_delimiters = " ,->()";
   const std::string default_loop_var = "zz";
 
@@ -171,6 +174,10 @@ namespace maestro {
         num_spatial_components_ = num_comp;
       }
 
+      int GetNumSpatialComponents() {
+        return num_spatial_components_;
+      }
+
       virtual ~SpatialMap() {}
 
       virtual std::string ToString() {
@@ -265,6 +272,86 @@ namespace maestro {
 
   }; // End of class Tile
 
+  /*
+   * Plain value form of a pragma, stored contiguously in a PragmaTable.
+   * The variable is an index into the variable names of the table.
+   */
+  class PragmaEntry {
+    public:
+      PragmaClass cls = PragmaClass::INVALID;
+      int var_id = -1;
+      int size = 1;
+      int offset = 1;
+      int num_spatial_components = 1;
+  }; // End of class PragmaEntry
+
+  /*
+   * Read-only handle to a PragmaEntry of a table, with the accessors of Pragma.
+   * Valid as long as the table it came from is alive and not appended to.
+   */
+  class PragmaView {
+    protected:
+      const PragmaEntry* entry_;
+      const std::vector<std::string>* var_names_;
+
+    public:
+      PragmaView(const PragmaEntry* entry, const std::vector<std::string>* var_names) :
+        entry_(entry),
+        var_names_(var_names)
+      {
+      }
+
+      const PragmaEntry& GetEntry() const {
+        return *entry_;
+      }
+
+      PragmaClass GetClass() const {
+        return entry_->cls;
+      }
+
+      int GetVarId() const {
+        return entry_->var_id;
+      }
+
+      const std::string& GetVarName() const {
+        return (*var_names_)[entry_->var_id];
+      }
+
+      int GetSize() const {
+        return entry_->size;
+      }
+
+      int GetOffset() const {
+        return entry_->offset;
+      }
+
+      int GetNumSpatialComponents() const {
+        return entry_->num_spatial_components;
+      }
+
+      // Builds the corresponding object of the Pragma class hierarchy
+      std::shared_ptr<Pragma> CreatePragma() const {
+        switch(entry_->cls) {
+          case PragmaClass::TEMPORAL_MAP:
+            return std::make_shared<TemporalMap>(this->GetVarName(), entry_->size, entry_->offset);
+          case PragmaClass::SPATIAL_MAP:
+            return std::make_shared<SpatialMap>(this->GetVarName(), entry_->size, entry_->offset, entry_->num_spatial_components);
+          case PragmaClass::TILE:
+            return std::make_shared<Tile>(this->GetVarName(), entry_->size);
+          case PragmaClass::UNROLL:
+            return std::make_shared<Unroll>(this->GetVarName());
+          case PragmaClass::MERGE:
+            return std::make_shared<Merge>(this->GetVarName());
+          default:
+            return std::make_shared<Pragma>(entry_->cls, this->GetVarName());
+        }
+      }
+
+      std::string ToString() const {
+        return this->CreatePragma()->ToString();
+      }
+  }; // End of class PragmaView
+
 }; // End of namespace maestro
 
 
@@ -0,0 +1,369 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_NETWORK_ANALYSIS_HPP_
+#define MAESTRO_NETWORK_ANALYSIS_HPP_
+
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "analysis-structure.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "layer-analysis.hpp"
+
+namespace maestro {
+
+  /*
+   * Analysis of consecutive layers that may be fused: the output of layer i
+   * stays in L2 and is consumed by layer i+1 without a DRAM round trip.
+   * Fused layers can also be pipelined, each on its own partition of the PE array.
+   */
+  class NetworkAnalysis {
+    protected:
+      std::vector<std::string> layer_names_;
+      std::vector<std::shared_ptr<LayerAnalysis>> layers_;
+
+      std::shared_ptr<NetworkOnChipModel> noc_model_;
+      std::shared_ptr<OffChipMemoryModel> dram_model_;
+
+      int num_pes_;
+      int num_alus_per_pe_;
+      long l2_size_; // 0: unbounded L2
+      SparseFormat sparse_format_;
+      int prefetch_depth_;
+      bool drain_overlap_;
+      std::shared_ptr<ReductionNetworkModel> reduction_model_;
+
+      long GetDimension(int layer_id, std::string var_name) {
+        auto loops = layers_[layer_id]->GetLoopInfoTable()->FindLoops(var_name);
+        if(loops->empty()) return 1;
+
+        return static_cast<long>(loops->front()->GetNumIter());
+      }
+
+      // Bytes of num_values values of a tensor of layer_id, at the precision the layer declares
+      long GetTensorBytes(int layer_id, std::string tensor_name, long num_values) {
+        return LoopInfoTable::GetBytes(num_values, layers_[layer_id]->GetLoopInfoTable()->GetTensorPrecision(tensor_name));
+      }
+
+      // Values of var in the output of layer_id; a strided window produces fewer than its window positions
+      long GetOutputDimension(int layer_id, std::string var_name) {
+        return layers_[layer_id]->GetLoopInfoTable()->GetOutputPositions(var_name);
+      }
+
+      // Input values of var; for a strided sliding window, more than the window positions of GetDimension
+      long GetInputDimension(int layer_id, std::string var_name) {
+        auto loops = layers_[layer_id]->GetLoopInfoTable()->FindLoops(var_name);
+        if(loops->empty()) return 1;
+
+        return static_cast<long>(loops->front()->GetExtent());
+      }
+
+      std::shared_ptr<LayerAnalysis> CreateLayerAnalysis(int layer_id, int num_pes) {
+        auto layer = layers_[layer_id];
+        auto new_layer = std::make_shared<LayerAnalysis>(layer->GetPragmaTable(), layer->GetLoopInfoTable(), noc_model_, num_pes);
+        new_layer->SetNumALUsPerPE(num_alus_per_pe_);
+        new_layer->SetOffChipMemory(l2_size_, dram_model_);
+        new_layer->SetSparseFormat(sparse_format_);
+        new_layer->SetPipeline(prefetch_depth_, drain_overlap_);
+        new_layer->SetReductionNetwork(reduction_model_);
+        return new_layer;
+      }
+
+    public:
+      NetworkAnalysis(std::shared_ptr<NetworkOnChipModel> noc_model, std::shared_ptr<OffChipMemoryModel> dram_model,
+                      int num_pes, int num_alus_per_pe, long l2_size) :
+        noc_model_(noc_model),
+        dram_model_(dram_model),
+        num_pes_(num_pes),
+        num_alus_per_pe_(num_alus_per_pe),
+        l2_size_(l2_size),
+        sparse_format_(SparseFormat::NONE),
+        prefetch_depth_(2),
+        drain_overlap_(false),
+        reduction_model_(nullptr)
+      {
+      }
+
+      // Applies to the layers added afterwards
+      void SetSparseFormat(SparseFormat sparse_format) {
+        sparse_format_ = sparse_format;
+      }
+
+      // Applies to the layers added afterwards
+      void SetReductionNetwork(std::shared_ptr<ReductionNetworkModel> reduction_model) {
+        reduction_model_ = reduction_model;
+      }
+
+      // Applies to the layers added afterwards
+      void SetPipeline(int prefetch_depth, bool drain_overlap) {
+        prefetch_depth_ = prefetch_depth;
+        drain_overlap_ = drain_overlap;
+      }
+
+      void AddLayer(std::string layer_name, std::shared_ptr<PragmaTable> prag_tbl, std::shared_ptr<LoopInfoTable> loop_tbl) {
+        auto layer = std::make_shared<LayerAnalysis>(prag_tbl, loop_tbl, noc_model_, num_pes_);
+        layer->SetNumALUsPerPE(num_alus_per_pe_);
+        layer->SetOffChipMemory(l2_size_, dram_model_);
+        layer->SetSparseFormat(sparse_format_);
+        layer->SetPipeline(prefetch_depth_, drain_overlap_);
+        layer->SetReductionNetwork(reduction_model_);
+
+        layer_names_.push_back(layer_name);
+        layers_.push_back(layer);
+      }
+
+      void Analyze() {
+        for(auto& layer : layers_) {
+          layer->Analyze();
+        }
+      }
+
+      int GetNumLayers() {
+        return layers_.size();
+      }
+
+      std::string GetLayerName(int layer_id) {
+        return layer_names_[layer_id];
+      }
+
+      std::shared_ptr<LayerAnalysis> GetLayer(int layer_id) {
+        return layers_[layer_id];
+      }
+
+      bool IsConvolution(int layer_id) {
+        return !layers_[layer_id]->GetLoopInfoTable()->GetOperator()->IsDeclared();
+      }
+
+      /*
+       * The intermediate tensor produced by layer_id and consumed by the next layer.
+       * Convolutions pass "output" to "input"; other operators pass their only output
+       * to the first input with the same number of values.
+       */
+      std::string GetConsumedTensor(int layer_id) {
+        auto producer_map = layers_[layer_id]->GetMapAnalysis();
+        auto consumer_map = layers_[layer_id+1]->GetMapAnalysis();
+
+        if(this->IsConvolution(layer_id) && this->IsConvolution(layer_id+1)) {
+          return "input";
+        }
+
+        long produced_size = 0;
+        for(auto& out_tensor_name : layers_[layer_id]->GetOutputTensors()) {
+          produced_size += producer_map->GetFullSize(out_tensor_name);
+        }
+
+        for(auto& in_tensor_name : layers_[layer_id+1]->GetInputTensors()) {
+          if(consumer_map->GetFullSize(in_tensor_name) == produced_size) {
+            return in_tensor_name;
+          }
+        }
+
+        return "";
+      }
+
+      /*
+       * For convolutions, the output of layer_id has as many channels as the input of the next layer,
+       * and at least as many rows and columns. Other operators need an input that matches the produced tensor.
+       */
+      bool IsShapeCompatible(int layer_id) {
+        if(layer_id + 1 >= this->GetNumLayers()) return false;
+
+        if(!this->IsConvolution(layer_id) || !this->IsConvolution(layer_id+1)) {
+          return !this->GetConsumedTensor(layer_id).empty();
+        }
+
+        bool channel_match = this->GetDimension(layer_id, "K") == this->GetDimension(layer_id+1, "C");
+        bool row_match = this->GetOutputDimension(layer_id, "Y") >= this->GetInputDimension(layer_id+1, "Y");
+        bool col_match = this->GetOutputDimension(layer_id, "X") >= this->GetInputDimension(layer_id+1, "X");
+
+        return channel_match && row_match && col_match;
+      }
+
+      /*
+       * Output rows of layer_id the next layer needs at once: one filter window,
+       * scaled by the downsampling (e.g., pooling) between the two layers.
+       * In bytes, at the precision the next layer reads them.
+       */
+      long GetIntermediateTileSize(int layer_id) {
+        auto consumed_tensor = this->GetConsumedTensor(layer_id);
+        if(!this->IsConvolution(layer_id) || !this->IsConvolution(layer_id+1)) {
+          auto consumer_map = layers_[layer_id+1]->GetMapAnalysis();
+          return this->GetTensorBytes(layer_id+1, consumed_tensor, consumer_map->GetMappedSize(consumed_tensor, false, false) * layers_[layer_id+1]->GetNumPEs());
+        }
+
+        long producer_rows = this->GetOutputDimension(layer_id, "Y");
+        long downsampling = producer_rows / this->GetInputDimension(layer_id+1, "Y");
+        downsampling = (downsampling == 0)? 1 : downsampling;
+
+        long filter_rows = this->GetDimension(layer_id+1, "R");
+        auto window = layers_[layer_id+1]->GetLoopInfoTable()->FindSlidingWindow("Y");
+        if(window != nullptr) {
+          filter_rows = window->GetWindowExtent(filter_rows);
+        }
+
+        long window_rows = std::min(producer_rows, filter_rows * downsampling);
+
+        return this->GetTensorBytes(layer_id+1, consumed_tensor, this->GetDimension(layer_id, "K") * this->GetOutputDimension(layer_id, "X") * window_rows);
+      }
+
+      // L2 space to run layer_id and layer_id+1 concurrently with the intermediate tile on chip
+      long GetFusedL2Requirement(int layer_id) {
+        return layers_[layer_id]->GetL2BufferRequirement()
+               + layers_[layer_id+1]->GetL2BufferRequirement()
+               + this->GetIntermediateTileSize(layer_id);
+      }
+
+      bool CanFuse(int layer_id) {
+        if(!this->IsShapeCompatible(layer_id)) return false;
+
+        return l2_size_ <= 0 || this->GetFusedL2Requirement(layer_id) <= l2_size_;
+      }
+
+      // The intermediate tensor is neither drained to DRAM by layer_id nor refilled by the next layer
+      long GetFusionDRAMSavings(int layer_id) {
+        auto producer_map = layers_[layer_id]->GetMapAnalysis();
+        auto consumer_map = layers_[layer_id+1]->GetMapAnalysis();
+
+        auto consumed_tensor = this->GetConsumedTensor(layer_id);
+        long savings = this->GetTensorBytes(layer_id+1, consumed_tensor, consumer_map->GetFullSize(consumed_tensor));
+        for(auto& out_tensor_name : layers_[layer_id]->GetOutputTensors()) {
+          savings += this->GetTensorBytes(layer_id, out_tensor_name, producer_map->GetFullSize(out_tensor_name));
+        }
+
+        return savings;
+      }
+
+      // Every L2 access for the DRAM transfers that fusion removes
+      long GetFusionL2Savings(int layer_id) {
+        return this->GetFusionDRAMSavings(layer_id);
+      }
+
+      /*
+       * Greedily grows each fusion group while the next layer is shape-compatible and
+       * the working sets of the whole group, with their intermediate tiles, fit in L2.
+       */
+      std::list<std::list<int>> GetFusionGroups() {
+        std::list<std::list<int>> groups;
+
+        std::list<int> curr_group = {0};
+        long curr_l2_requirement = layers_[0]->GetL2BufferRequirement();
+
+        for(int layer_id = 0; layer_id + 1 < this->GetNumLayers(); layer_id++) {
+          long next_l2_requirement = curr_l2_requirement
+                                     + this->GetIntermediateTileSize(layer_id)
+                                     + layers_[layer_id+1]->GetL2BufferRequirement();
+
+          if(this->CanFuse(layer_id) && (l2_size_ <= 0 || next_l2_requirement <= l2_size_)) {
+            curr_group.push_back(layer_id+1);
+            curr_l2_requirement = next_l2_requirement;
+          }
+          else {
+            groups.push_back(curr_group);
+            curr_group = {layer_id+1};
+            curr_l2_requirement = layers_[layer_id+1]->GetL2BufferRequirement();
+          }
+        }
+        groups.push_back(curr_group);
+
+        return groups;
+      }
+
+      /*
+       * Splits the PE array in proportion to the operations of each layer in the group.
+       * Each partition is rounded down to a multiple of the cluster size of its dataflow.
+       * Returns an empty vector if the array cannot hold one partition per layer.
+       */
+      std::vector<int> PartitionPEs(std::list<int> group) {
+        std::vector<int> partitions;
+        std::vector<int> min_partitions;
+
+        long total_ops = 0;
+        for(auto& layer_id : group) {
+          total_ops += layers_[layer_id]->GetTotalOps();
+        }
+
+        int num_assigned_pes = 0;
+        for(auto& layer_id : group) {
+          int min_num_pes = layers_[layer_id]->GetMinNumPEs();
+          int num_pes = static_cast<int>(static_cast<double>(num_pes_) * layers_[layer_id]->GetTotalOps() / total_ops);
+          num_pes = std::max(min_num_pes, (num_pes / min_num_pes) * min_num_pes);
+
+          partitions.push_back(num_pes);
+          min_partitions.push_back(min_num_pes);
+          num_assigned_pes += num_pes;
+        }
+
+        while(num_assigned_pes > num_pes_) {
+          int largest = -1;
+          for(size_t idx = 0; idx < partitions.size(); idx++) {
+            if(partitions[idx] > min_partitions[idx] && (largest == -1 || partitions[idx] > partitions[largest])) {
+              largest = static_cast<int>(idx);
+            }
+          }
+
+          if(largest == -1) {
+            partitions.clear();
+            break;
+          }
+
+          partitions[largest] -= min_partitions[largest];
+          num_assigned_pes -= min_partitions[largest];
+        }
+
+        return partitions;
+      }
+
+      // Runtime of the group when its layers run one after another on the whole array
+      long GetSequentialRuntime(std::list<int> group) {
+        long runtime = 0;
+        for(auto& layer_id : group) {
+          runtime += layers_[layer_id]->GetRuntime();
+        }
+        return runtime;
+      }
+
+      /*
+       * Initiation interval of the group when each layer runs on its own partition:
+       * the slowest pipeline stage. Returns -1 if the group cannot be partitioned.
+       */
+      long GetPipelinedInterval(std::list<int> group) {
+        auto partitions = this->PartitionPEs(group);
+        if(partitions.empty()) return -1;
+
+        long interval = 0;
+        int stage_id = 0;
+        for(auto& layer_id : group) {
+          auto stage = this->CreateLayerAnalysis(layer_id, partitions[stage_id]);
+          stage->Analyze();
+          interval = std::max(interval, stage->GetRuntime());
+          stage_id++;
+        }
+
+        return interval;
+      }
+  }; // End of class NetworkAnalysis
+
+}; // End of namespace maestro
+
+#endif
@@ -24,7 +24,7 @@ namespace maestro {
 
   class NetworkOnChipModel {
     protected:
-      int bandwidth_;
+      int bandwidth_; // Bytes per cycle
       int num_average_hops_;
       int latency_per_hops_;
       bool multicast_support_;
@@ -50,6 +50,10 @@ namespace maestro {
       	bandwidth_ = bw;
       }
 
+      long GetZeroLoadDelay() {
+        return static_cast<long>(num_average_hops_) * latency_per_hops_;
+      }
+
       long GetOutStandingDelay(long data_amount) {
         long delay;
 
@@ -61,7 +65,7 @@ namespace maestro {
           num_sends = data_amount / bandwidth_;
         }
 
-        long avg_zero_load_delay = num_average_hops_ * latency_per_hops_;
+        long avg_zero_load_delay = this->GetZeroLoadDelay();
 
         delay = avg_zero_load_delay // Head delay
                 + (num_sends-1); // Pipeline delay
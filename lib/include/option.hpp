@@ -22,6 +22,7 @@ SOFTWARE.
 
 #include <iostream>
 #include <list>
+#include <vector>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -38,17 +39,41 @@ namespace maestro {
       int hops = 1;
       int hop_latency = 1;
       bool mc = true;
-      std::list<std::string> in_tensors = {"weight", "input"};
-      std::list<std::string> out_tensors = {"output"};
+      long l2_size = 0;
+      int dram_bw = 0;
+      int dram_latency = 100;
+      std::string sparse_format = "none";
 
       std::string dataflow_file_name = "data/dataflow/maeri.m";
       std::string layer_file_name = "data/layer/vgg16_conv1.m";
+      std::string network_file_name = "";
+      std::vector<std::string> dataflow_params;
+      std::string trace_file_name = "";
 
       int num_alus_per_pe = 9;
+      std::vector<int> num_pes_sweep;
       bool do_reduction = true;
       bool do_implicit_reduction = true;
       bool fg_sync = false;
-
+      int prefetch_depth = 2;
+      bool drain_overlap = false;
+      std::string reduction_network = "l2";
+      int reduction_bw = 32;
+      int reduction_latency = 1;
+      double reduction_energy = 0.5;
+
+      int num_chiplets = 1;
+      std::string chiplet_partition = "all";
+      int interchip_bw = 16;
+      int interchip_latency = 100;
+
+      std::string sweep_file_name = "";
+      std::string sweep_output_file_name = "";
+      int sweep_threads = 0;
+
+      bool server = false;
+      std::string server_socket = "";
+      int server_threads = 0;
 
       bool parse(int argc, char** argv)
       {
@@ -63,22 +88,44 @@ namespace maestro {
           io.add_options()
             ("dataflow_file", po::value<std::string>(&dataflow_file_name) ,"the name of dataflow description file")
             ("layer_file", po::value<std::string>(&layer_file_name) ,"the name of layer dimension description file")
+            ("network_file", po::value<std::string>(&network_file_name) ,"the name of network description file (pairs of dataflow and layer files); enables the layer fusion analysis")
+            ("dataflow_params", po::value<std::vector<std::string>>(&dataflow_params)->multitoken(), "values of the symbolic sizes of the dataflow (e.g., Tk=4 Cx=3)")
+            ("trace_file", po::value<std::string>(&trace_file_name), "the name of a Chrome trace-event JSON file to write the modeled schedule of the layer to (viewable in Perfetto)")
           ;
 
           po::options_description nocs("Network on chip options");
           nocs.add_options()
-            ("noc_bw", po::value<int>(&bw), "the bandwidth of NoC")
+            ("noc_bw", po::value<int>(&bw), "the bandwidth of NoC in bytes per cycle")
             ("noc_hops", po::value<int>(&hops), "the average number of NoC hops")
             ("noc_hop_latency", po::value<int>(&hop_latency), "the latency for each of NoC hop")
             ("noc_mc_support", po::value<bool>(&mc), "the multicasting capability of NoC")
           ;
 
+          po::options_description memory("Memory hierarchy options");
+          memory.add_options()
+            ("l2_size", po::value<long>(&l2_size), "the capacity of L2 buffer in bytes; 0 models an unbounded L2")
+            ("dram_bw", po::value<int>(&dram_bw), "the bandwidth of off-chip DRAM in bytes per cycle; 0 disables the DRAM model")
+            ("dram_latency", po::value<int>(&dram_latency), "the access latency of off-chip DRAM")
+          ;
+
+          po::options_description sparsity("Sparsity options");
+          sparsity.add_options()
+            ("sparse_format", po::value<std::string>(&sparse_format), "the compressed format of sparse tensors (none, bitmap, or rle); densities are given in the layer file")
+          ;
+
           po::options_description pe_array("Processing element options");
           pe_array.add_options()
             ("num_pes", po::value<int>(&np), "the number of PEs")
             ("num_pe_alus", po::value<int>(&num_alus_per_pe), "the number of ALUs in each PE")
+            ("num_pes_sweep", po::value<std::vector<int>>(&num_pes_sweep)->multitoken(), "a list of PE counts to additionally analyze the layer on (e.g., 16 64 256 1024)")
             ("do_implicit_reduction", po::value<bool>(&do_implicit_reduction), "If PEs reduce items as soon as they generate partial results; if set as true, reductions do not require additional cycles.")
             ("do_fg_sync", po::value<bool>(&fg_sync), "Fine-grained synchronization is performed (future work)")
+            ("prefetch_depth", po::value<int>(&prefetch_depth), "the number of input tiles each PE buffers; 1 disables prefetching, 2 is double buffering, and deeper prefetching also overlaps the NoC latency of consecutive tiles")
+            ("drain_overlap", po::value<bool>(&drain_overlap), "If PEs send the outputs of a fold while computing the next one; otherwise, the two take turns")
+            ("reduction_network", po::value<std::string>(&reduction_network), "how PEs of a spatial map over a reduction variable combine partial sums: l2 (sent to L2 and accumulated there), tree (adder tree), or chain (systolic accumulation chain)")
+            ("reduction_bw", po::value<int>(&reduction_bw), "the bytes of partial sums each stage of the reduction network accepts per cycle")
+            ("reduction_latency", po::value<int>(&reduction_latency), "the latency of each stage of the reduction network")
+            ("reduction_energy", po::value<double>(&reduction_energy), "the energy of an addition in the reduction network, in the unit of MAC energy")
           ;
 
           po::options_description problem("Problem description options");
@@ -87,18 +134,55 @@ namespace maestro {
               //TODO: Add correlated variables here
           ;
 
+          po::options_description chiplets("Multi-chiplet options");
+          chiplets.add_options()
+            ("num_chiplets", po::value<int>(&num_chiplets), "the number of chiplets, each with the PEs, NoC, and L2 of the other options, to split the layer across")
+            ("chiplet_partition", po::value<std::string>(&chiplet_partition), "the loop variable to split the layer along (e.g., K, Y, or C with a cross-chip reduction), or all to compare every variable")
+            ("interchip_bw", po::value<int>(&interchip_bw), "the bytes each chiplet sends and receives per cycle over the inter-chip link")
+            ("interchip_latency", po::value<int>(&interchip_latency), "the latency of each transfer over the inter-chip link")
+          ;
+
+          po::options_description sweep("Design space sweep options");
+          sweep.add_options()
+            ("sweep_file", po::value<std::string>(&sweep_file_name), "the name of a sweep specification file (ranges, lists, and log-scale grids of hardware options and map sizes, and constraints)")
+            ("sweep_output", po::value<std::string>(&sweep_output_file_name), "the name of a CSV file to write every accepted design point of the sweep to")
+            ("sweep_threads", po::value<int>(&sweep_threads), "the number of threads evaluating the sweep; 0 uses every hardware thread")
+          ;
+
+          po::options_description server_options("Evaluation server options");
+          server_options.add_options()
+            ("server", po::bool_switch(&server), "serve evaluation requests on stdin and write responses to stdout; other options become request defaults")
+            ("server_socket", po::value<std::string>(&server_socket), "serve evaluation requests on a Unix domain socket at this path")
+            ("server_threads", po::value<int>(&server_threads), "the number of threads evaluating server requests; 0 uses every hardware thread")
+          ;
+
           po::options_description all_options;
           all_options.add(desc);
           all_options.add(io);
           all_options.add(nocs);
+          all_options.add(memory);
+          all_options.add(sparsity);
           all_options.add(pe_array);
           all_options.add(problem);
+          all_options.add(chiplets);
+          all_options.add(sweep);
+          all_options.add(server_options);
 
 
           po::variables_map vm;
           po::store(po::parse_command_line(argc, argv, all_options), vm);
           po::notify(vm);
 
+          // dram_bw 0 disables the DRAM model; a negative one would reach its delays
+          if(bw <= 0) {
+            std::cout << "[MAESTRO] Error; the NoC bandwidth must be positive" << std::endl;
+            return false;
+          }
+          if(dram_bw < 0 || dram_latency < 0) {
+            std::cout << "[MAESTRO] Error; the DRAM bandwidth and latency must be non-negative" << std::endl;
+            return false;
+          }
+
           return true;
       }
   }; //End of class Options
@@ -23,29 +23,46 @@ SOFTWARE.
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <memory>
 #include <cstdlib>
+#include <cctype>
+#include <list>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
 
 #include<boost/tokenizer.hpp>
 #include<boost/format.hpp>
 
 #include "analysis-structure.hpp"
+#include "sweep-spec.hpp"
+#include "dataflow-template.hpp"
 
 namespace maestro {
 
   class InputParser {
     protected:
       std::string file_name_;
-      std::ifstream in_file_;
+      std::shared_ptr<std::istream> in_file_;
 
     public:
       InputParser(std::string file_nm) :
         file_name_(file_nm)
       {
-        in_file_.open(file_nm);
-        if(!in_file_) {
+        in_file_ = std::make_shared<std::ifstream>(file_nm);
+        if(!(*in_file_)) {
           std::cout << "Failed to open the input file" << std::endl;
         }
       }
+
+      // Parses a description that is already in memory (e.g., a std::istringstream)
+      InputParser(std::shared_ptr<std::istream> in_stream) :
+        file_name_(""),
+        in_file_(in_stream)
+      {
+      }
   }; // End of class InputParser
 
   class PragmaParser : public InputParser {
@@ -65,12 +82,28 @@ namespace maestro {
       {
       }
 
+      PragmaParser(std::shared_ptr<std::istream> in_stream) :
+        InputParser(in_stream),
+        num_pes_(1)
+      {
+      }
+
+      // Symbolic sizes are left as 1; use ParseTemplate() to bind them
       std::shared_ptr<PragmaTable> ParsePragmas() {
+        return this->ParseTemplate()->GetPragmaTable();
+      }
+
+      /*
+       * Sizes and offsets may be numbers, parameter names (e.g., Tk), or Sz(<loop variable>);
+       * the latter two are recorded as sites of the template.
+       */
+      std::shared_ptr<DataflowTemplate> ParseTemplate() {
         auto prag_table = std::make_shared<PragmaTable>();
+        std::vector<TemplateSite> sites;
         std::string line;
 
         //Read a line of the file
-        while(std::getline(in_file_, line)) {
+        while(std::getline(*in_file_, line)) {
           boost::char_separator<char> sep(" ,->()");
           boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
 
@@ -83,6 +116,37 @@ namespace maestro {
           int tile_size = 1;
           int map_offset = 1;
 
+          // Sz(R) is tokenized into Sz and R
+          bool in_loop_size = false;
+
+          // Returns true once the size is complete
+          auto read_size = [&](const std::string& tok, int& size, bool is_offset) {
+            TemplateSite site;
+            site.pragma_pos = prag_table->GetPragmaCounts();
+            site.is_offset = is_offset;
+
+            if(in_loop_size) {
+              in_loop_size = false;
+              site.expression.cls = SizeTermClass::LOOP_SIZE;
+            }
+            else if(tok == tkn_loop_size) {
+              in_loop_size = true;
+              return false;
+            }
+            else if(std::isdigit(static_cast<unsigned char>(tok[0])) || tok[0] == '-' || tok[0] == '+') {
+              size = std::atoi(tok.c_str());
+              return true;
+            }
+            else {
+              site.expression.cls = SizeTermClass::PARAMETER;
+            }
+
+            site.expression.name = tok;
+            sites.push_back(site);
+            size = 1;
+            return true;
+          };
+
           for(auto& tok : tokn) {
 
             switch(pragma_cls) {
@@ -107,12 +171,10 @@ namespace maestro {
               case(PragmaClass::TEMPORAL_MAP):
               case(PragmaClass::SPATIAL_MAP): {
                 if(!saw_size) {
-                  map_size = std::atoi(tok.c_str());
-                  saw_size = true;
+                  saw_size = read_size(tok, map_size, false);
                 }
                 else if(!saw_ofs) {
-                  map_offset = std::atoi(tok.c_str());
-                  saw_ofs = true;
+                  saw_ofs = read_size(tok, map_offset, true);
                 }
                 else {
                   loop_var = tok;
@@ -121,8 +183,7 @@ namespace maestro {
               }
               case(PragmaClass::TILE): {
                 if(!saw_size) {
-                  tile_size = std::atoi(tok.c_str());
-                  saw_size = true;
+                  saw_size = read_size(tok, tile_size, false);
                 }
                 else {
                   loop_var = tok;
@@ -169,7 +230,7 @@ namespace maestro {
 
         }
 
-        return prag_table;
+        return std::make_shared<DataflowTemplate>(prag_table, sites);
       }
   }; // End of class PragmaParser
 
@@ -180,12 +241,16 @@ namespace maestro {
         InputParser(file_nm) {
       }
 
+      ProgramParser(std::shared_ptr<std::istream> in_stream) :
+        InputParser(in_stream) {
+      }
+
       std::shared_ptr<LoopInfoTable> ParseProgram() {
         auto prob_table = std::make_shared<LoopInfoTable>();
         std::string line;
 
         //Read a line of the file
-        while(std::getline(in_file_, line)) {
+        while(std::getline(*in_file_, line)) {
           boost::char_separator<char> sep(" ,->()");
           boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
 
@@ -228,17 +293,71 @@ namespace maestro {
       {
       }
 
+      ProblemParser(std::shared_ptr<std::istream> in_stream) :
+        InputParser(in_stream)
+      {
+      }
+
       std::shared_ptr<LoopInfoTable> ParseProblem() {
         auto prob_table = std::make_shared<LoopInfoTable>();
+        std::shared_ptr<OperatorInformation> operator_info = nullptr;
+        std::map<std::string, int> strides;
+        std::map<std::string, int> dilations;
 
-        auto prag_table = std::make_shared<PragmaTable>();
         std::string line;
 
         //Read a line of the file
-        while(std::getline(in_file_, line)) {
+        while(std::getline(*in_file_, line)) {
           boost::char_separator<char> sep(" ,->()");
           boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
 
+          std::vector<std::string> tokens(tokn.begin(), tokn.end());
+          if(tokens.size() > 0 && (tokens[0] == tkn_input_tensor || tokens[0] == tkn_output_tensor
+                                   || tokens[0] == tkn_reduction || tokens[0] == tkn_batch)) {
+            if(operator_info == nullptr) {
+              operator_info = std::make_shared<OperatorInformation>();
+            }
+            ParseOperatorDescription(tokens, operator_info);
+            continue;
+          }
+
+          if(tokens.size() > 0 && tokens[0] == tkn_density) {
+            if(tokens.size() == 3) {
+              prob_table->SetTensorDensity(tokens[1], std::atof(tokens[2].c_str()));
+            }
+            else {
+              std::cout << "[ProblemParser]Warning: A density declaration requires a tensor name and a density. Ignoring the declaration" << std::endl;
+            }
+            continue;
+          }
+
+          // Precision <tensor> <bits> [<partial sum bits>]
+          if(tokens.size() > 0 && tokens[0] == tkn_precision) {
+            int bits = (tokens.size() >= 3)? std::atoi(tokens[2].c_str()) : 0;
+            int partial_sum_bits = (tokens.size() == 4)? std::atoi(tokens[3].c_str()) : 0;
+            if(tokens.size() < 3 || tokens.size() > 4 || bits <= 0 || (tokens.size() == 4 && partial_sum_bits <= 0)) {
+              std::cout << "[ProblemParser]Warning: A precision declaration requires a tensor name and a positive number of bits (and optionally of partial sum bits). Ignoring the declaration" << std::endl;
+            }
+            else {
+              prob_table->SetTensorPrecision(tokens[1], bits, partial_sum_bits);
+            }
+            continue;
+          }
+
+          if(tokens.size() > 0 && (tokens[0] == tkn_stride || tokens[0] == tkn_dilation)) {
+            auto& factors = (tokens[0] == tkn_stride)? strides : dilations;
+            if(tokens.size() == 2) {
+              factors[""] = std::atoi(tokens[1].c_str());
+            }
+            else if(tokens.size() == 3) {
+              factors[tokens[1]] = std::atoi(tokens[2].c_str());
+            }
+            else {
+              std::cout << "[ProblemParser]Warning: A " << tokens[0] << " declaration requires a value and optionally a variable. Ignoring the declaration" << std::endl;
+            }
+            continue;
+          }
+
           std::string loop_var = default_loop_var;
 
           bool saw_size = false;
@@ -258,14 +377,262 @@ namespace maestro {
             }
           }
 
+          if(loop_var == default_loop_var) { // Empty line
+            continue;
+          }
+
           auto loop_info = std::make_shared<LoopInformation>(loop_var, 0, size);
           prob_table->AddLoop(loop_info);
 
         }
+
+        // Layers without a description are convolutions; build it once instead of on every GetOperator()
+        if(operator_info == nullptr) {
+          operator_info = prob_table->GetOperator();
+        }
+        else {
+          CheckTensorVariables(prob_table, operator_info);
+        }
+        prob_table->SetOperator(operator_info);
+
+        ConfigureSlidingWindows(prob_table, operator_info, strides, dilations);
+
         return prob_table;
       }
 
+    protected:
+      /*
+       * Stride 2       (every sliding window)
+       * Dilation Y 2   (the window over Y only)
+       * A strided loop iterates over window positions; its bound stays the input size.
+       */
+      void ConfigureSlidingWindows(std::shared_ptr<LoopInfoTable> prob_table, std::shared_ptr<OperatorInformation> operator_info,
+                                   std::map<std::string, int>& strides, std::map<std::string, int>& dilations) {
+        std::list<std::string> window_vars;
+
+        for(auto& window : operator_info->GetSlidingWindows()) {
+          auto var = std::get<0>(window);
+          auto loop = prob_table->FindLoop(var);
+          if(loop == nullptr) continue;
+          window_vars.push_back(var);
+
+          int stride = GetWindowFactor(strides, var);
+          int dilation = GetWindowFactor(dilations, var);
+          if(stride < 1 || dilation < 1) {
+            std::cout << "[ProblemParser]Warning: Stride and dilation of " << var << " must be positive. Using 1" << std::endl;
+            stride = std::max(stride, 1);
+            dilation = std::max(dilation, 1);
+          }
+
+          prob_table->SetSlidingWindow(var, SlidingWindow(std::get<1>(window), stride, dilation));
+          loop->SetIncrement(stride);
+        }
+
+        for(auto factors : {strides, dilations}) {
+          for(auto& factor : factors) {
+            bool is_window_var = factor.first.empty() || std::find(window_vars.begin(), window_vars.end(), factor.first) != window_vars.end();
+            if(!is_window_var || window_vars.empty()) {
+              std::cout << "[ProblemParser]Warning: No filter slides over " << (factor.first.empty()? "this layer" : factor.first)
+                        << ". Ignoring its stride and dilation" << std::endl;
+            }
+          }
+        }
+      }
+
+      // Tensor declarations may precede the dimensions, so they are checked once every loop is known
+      void CheckTensorVariables(std::shared_ptr<LoopInfoTable> prob_table, std::shared_ptr<OperatorInformation> operator_info) {
+        // Iterates over a copy; dropped declarations are removed from the operator
+        auto tensors = operator_info->GetTensorInformation();
+        for(auto& tensor : tensors) {
+          for(auto& var : tensor->GetVariables()) {
+            if(prob_table->FindLoop(var) == nullptr) {
+              std::cout << "[ProblemParser]Warning: Tensor " << tensor->GetName() << " is indexed by " << var
+                        << ", which is not a dimension of the layer. Ignoring the declaration" << std::endl;
+              operator_info->RemoveTensor(tensor->GetName());
+              break;
+            }
+          }
+        }
+      }
+
+      int GetWindowFactor(std::map<std::string, int>& factors, std::string var) {
+        if(factors.find(var) != factors.end()) return factors[var];
+        if(factors.find("") != factors.end()) return factors[""];
+        return 1;
+      }
+
+      /*
+       * Input_Tensor weight (K,C,R,S)
+       * Output_Tensor output (K,Y,X)
+       * Reduction (C,R,S)
+       * Batch (N)
+       */
+      void ParseOperatorDescription(std::vector<std::string>& tokens, std::shared_ptr<OperatorInformation> operator_info) {
+        if(tokens[0] == tkn_input_tensor || tokens[0] == tkn_output_tensor) {
+          if(tokens.size() < 2) {
+            std::cout << "[ProblemParser]Warning: A tensor declaration requires a tensor name. Ignoring the declaration" << std::endl;
+            return;
+          }
+
+          TensorClass tensor_class = (tokens[0] == tkn_input_tensor)? TensorClass::INPUT : TensorClass::OUTPUT;
+          std::list<std::string> variables(tokens.begin() + 2, tokens.end());
+          operator_info->AddTensor(std::make_shared<TensorInformation>(tokens[1], tensor_class, variables));
+        }
+        else if(tokens[0] == tkn_reduction) {
+          for(size_t idx = 1; idx < tokens.size(); idx++) {
+            operator_info->AddReductionVariable(tokens[idx]);
+          }
+        }
+        else if(tokens[0] == tkn_batch) {
+          if(tokens.size() == 2) {
+            operator_info->SetBatchVariable(tokens[1]);
+          }
+          else {
+            std::cout << "[ProblemParser]Warning: A batch declaration requires exactly one variable. Ignoring the declaration" << std::endl;
+          }
+        }
+      }
+
   }; // End of class ProblemParser
+
+  class NetworkParser : public InputParser {
+    protected:
+
+    public:
+      NetworkParser(std::string file_nm) :
+        InputParser(file_nm)
+      {
+      }
+
+      NetworkParser(std::shared_ptr<std::istream> in_stream) :
+        InputParser(in_stream)
+      {
+      }
+
+      // Each line lists the dataflow file and the layer file of one layer, in execution order
+      std::list<std::tuple<std::string, std::string>> ParseNetwork() {
+        std::list<std::tuple<std::string, std::string>> layers;
+        std::string line;
+
+        //Read a line of the file
+        while(std::getline(*in_file_, line)) {
+          boost::char_separator<char> sep(" \t");
+          boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
+
+          std::vector<std::string> file_names(tokn.begin(), tokn.end());
+
+          if(file_names.size() == 0) {
+            continue;
+          }
+          else if(file_names.size() != 2) {
+            std::cout << "[NetworkParser]Warning: Each layer requires a dataflow file and a layer file. Ignoring line: " << line << std::endl;
+            continue;
+          }
+
+          layers.push_back({file_names[0], file_names[1]});
+        }
+
+        return layers;
+      }
+
+  }; // End of class NetworkParser
+
+  /*
+   * A sweep specification lists one swept parameter or one constraint per line:
+   *   num_pes range 64 1024 64        (start, end, step)
+   *   noc_bw list 16 32 64
+   *   l2_size log 4096 1048576 4      (start, end, factor)
+   *   Map K list 1 2 4 8              (size of the map directive of loop variable K)
+   *   Param Tk list 1 2 4             (symbolic size Tk of a dataflow template)
+   *   Constraint noc_bw <= num_pes
+   *   Constraint l1_buffer_requirement <= 512
+   * Lines starting with # are comments.
+   */
+  class SweepSpecParser : public InputParser {
+    protected:
+      bool ParseComparisonOp(std::string op_name, ComparisonOp& op) {
+        if(op_name == "<") op = ComparisonOp::LT;
+        else if(op_name == "<=") op = ComparisonOp::LE;
+        else if(op_name == ">") op = ComparisonOp::GT;
+        else if(op_name == ">=") op = ComparisonOp::GE;
+        else if(op_name == "==") op = ComparisonOp::EQ;
+        else if(op_name == "!=") op = ComparisonOp::NE;
+        else return false;
+
+        return true;
+      }
+
+    public:
+      SweepSpecParser(std::string file_nm) :
+        InputParser(file_nm)
+      {
+      }
+
+      SweepSpecParser(std::shared_ptr<std::istream> in_stream) :
+        InputParser(in_stream)
+      {
+      }
+
+      std::shared_ptr<SweepSpec> ParseSweepSpec() {
+        auto spec = std::make_shared<SweepSpec>();
+        std::string line;
+
+        //Read a line of the file
+        while(std::getline(*in_file_, line)) {
+          boost::char_separator<char> sep(" \t\r");
+          boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
+
+          std::vector<std::string> tokens(tokn.begin(), tokn.end());
+          if(tokens.size() == 0 || tokens[0][0] == '#') {
+            continue;
+          }
+
+          if(tokens[0] == tkn_sweep_constraint) {
+            SweepConstraint constraint;
+            if(tokens.size() != 4 || !ParseComparisonOp(tokens[2], constraint.op)) {
+              std::cout << "[SweepSpecParser]Warning: A constraint requires two operands and a comparison (<, <=, >, >=, ==, !=). Ignoring line: " << line << std::endl;
+              continue;
+            }
+            constraint.lhs = tokens[1];
+            constraint.rhs = tokens[3];
+            spec->AddConstraint(constraint);
+            continue;
+          }
+
+          SweepTarget target = SweepTarget::HARDWARE;
+          if(tokens[0] == tkn_sweep_map) target = SweepTarget::MAP_SIZE;
+          else if(tokens[0] == tkn_sweep_param) target = SweepTarget::DATAFLOW_PARAMETER;
+          std::size_t name_pos = (target == SweepTarget::HARDWARE)? 0 : 1;
+          if(tokens.size() < name_pos + 3) {
+            std::cout << "[SweepSpecParser]Warning: A swept parameter requires a name, a kind (list, range, or log), and values. Ignoring line: " << line << std::endl;
+            continue;
+          }
+
+          auto name = tokens[name_pos];
+          auto kind = tokens[name_pos + 1];
+          std::vector<long> values;
+          for(std::size_t pos = name_pos + 2; pos < tokens.size(); pos++) {
+            values.push_back(std::atol(tokens[pos].c_str()));
+          }
+
+          if(kind == tkn_sweep_list) {
+            spec->AddDimension(SweepDimension(name, target, values));
+          }
+          else if(kind == tkn_sweep_range && values.size() == 3 && values[2] > 0) {
+            spec->AddDimension(SweepDimension(name, target, SweepKind::RANGE, values[0], values[1], values[2]));
+          }
+          else if(kind == tkn_sweep_log && values.size() == 3 && values[0] > 0 && values[2] > 1) {
+            spec->AddDimension(SweepDimension(name, target, SweepKind::LOG, values[0], values[1], values[2]));
+          }
+          else {
+            std::cout << "[SweepSpecParser]Warning: Expected \"list <values>\", \"range <start> <end> <step>\", or \"log <start> <end> <factor>\". Ignoring line: " << line << std::endl;
+          }
+        }
+
+        return spec;
+      }
+
+  }; // End of class SweepSpecParser
 }; // End of namespace maestro
 
 #endif
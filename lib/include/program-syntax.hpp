@@ -24,6 +24,15 @@ SOFTWARE.
 
 namespace maestro {
 
+  const std::string tkn_input_tensor = "Input_Tensor";
+  const std::string tkn_output_tensor = "Output_Tensor";
+  const std::string tkn_reduction = "Reduction";
+  const std::string tkn_batch = "Batch";
+  const std::string tkn_density = "Density";
+  const std::string tkn_precision = "Precision";
+  const std::string tkn_stride = "Stride";
+  const std::string tkn_dilation = "Dilation";
+
   enum class BinaryOp {
     ADD,
     SUB,
@@ -0,0 +1,117 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_REDUCTION_NETWORK_MODEL_HPP_
+#define MAESTRO_REDUCTION_NETWORK_MODEL_HPP_
+
+#include <string>
+
+#include "checked-arithmetic.hpp"
+
+namespace maestro {
+
+  enum class ReductionNetwork {
+    L2,   // Every PE sends its partial sums over the NoC, and L2 accumulates them
+    TREE, // An adder tree across the PEs
+    CHAIN // A systolic accumulation chain: each PE adds its partial sums and passes them on
+  };
+
+  /*
+   * How PEs that compute partial sums of the same outputs, i.e., PEs of a spatial map over a
+   * reduction variable, combine them before the outputs reach L2.
+   */
+  class ReductionNetworkModel {
+    protected:
+      ReductionNetwork topology_;
+      int bandwidth_;     // Bytes of partial sums each stage accepts per cycle
+      int latency_;       // Cycles per stage
+      double add_energy_; // Energy of one addition in the network, in the unit of MAC energy
+
+    public:
+      ReductionNetworkModel(ReductionNetwork topology, int bw, int latency, double add_energy) :
+        topology_(topology),
+        bandwidth_(bw),
+        latency_(latency),
+        add_energy_(add_energy)
+      {
+      }
+
+      ReductionNetwork GetTopology() {
+        return topology_;
+      }
+
+      std::string GetTopologyName() {
+        switch(topology_) {
+          case ReductionNetwork::TREE:
+            return "tree";
+          case ReductionNetwork::CHAIN:
+            return "chain";
+          default:
+            return "l2";
+        }
+      }
+
+      // If partial sums are reduced before they are sent to L2
+      bool ReducesInNetwork() {
+        return topology_ != ReductionNetwork::L2;
+      }
+
+      double GetAddEnergy() {
+        return add_energy_;
+      }
+
+      long GetNumStages(long num_pes) {
+        if(!this->ReducesInNetwork() || num_pes <= 1) return 0;
+
+        if(topology_ == ReductionNetwork::CHAIN) return num_pes - 1;
+
+        long num_stages = 0;
+        for(long width = 1; width < num_pes; width *= 2) {
+          num_stages++;
+        }
+        return num_stages;
+      }
+
+      // Cycles to reduce data_amount partial sums of each of num_pes PEs into one set; stages are pipelined
+      long GetReductionDelay(long num_pes, long data_amount) {
+        long num_stages = this->GetNumStages(num_pes);
+        if(num_stages == 0 || data_amount <= 0) return 0;
+
+        long num_sends = data_amount / bandwidth_;
+        if(data_amount % bandwidth_ != 0) {
+          num_sends++;
+        }
+
+        return CheckedAdd(CheckedMul(num_stages, latency_), // Head delay
+                          num_sends-1); // Pipeline delay
+      }
+  }; // End of class ReductionNetworkModel
+
+  // Returns false if name is not a reduction network
+  inline bool ParseReductionNetwork(const std::string& name, ReductionNetwork& topology) {
+    if(name == "l2") topology = ReductionNetwork::L2;
+    else if(name == "tree") topology = ReductionNetwork::TREE;
+    else if(name == "chain") topology = ReductionNetwork::CHAIN;
+    else return false;
+
+    return true;
+  }
+
+}; // End of namespace maestro
+#endif
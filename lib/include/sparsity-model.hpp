@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_SPARSITY_MODEL_HPP_
+#define MAESTRO_SPARSITY_MODEL_HPP_
+
+#include <string>
+#include <list>
+#include <map>
+#include <cmath>
+#include <algorithm>
+
+namespace maestro {
+
+  enum class SparseFormat {
+    NONE,   // Zeros are stored and moved; no operation is skipped
+    BITMAP, // Non-zero values plus one bit per value
+    RLE     // Non-zero values, each with the run length of zeros before it
+  };
+
+  /*
+   * Per-tensor density (fraction of non-zero values) and the compressed format of sparse tensors.
+   * Tensors with density 1.0 stay dense regardless of the format.
+   */
+  class SparsityModel {
+    protected:
+      SparseFormat format_;
+      std::map<std::string, double> densities_;
+
+      int value_bits_;
+      int run_length_bits_;
+
+    public:
+      SparsityModel(SparseFormat format, std::map<std::string, double> densities) :
+        format_(format),
+        densities_(densities),
+        value_bits_(8),
+        run_length_bits_(4)
+      {
+      }
+
+      SparseFormat GetFormat() {
+        return format_;
+      }
+
+      std::string GetFormatName() {
+        switch(format_) {
+          case SparseFormat::BITMAP:
+            return "bitmap";
+          case SparseFormat::RLE:
+            return "rle";
+          default:
+            return "none";
+        }
+      }
+
+      double GetDensity(std::string tensor_name) {
+        if(densities_.find(tensor_name) == densities_.end()) return 1.0;
+
+        return densities_[tensor_name];
+      }
+
+      bool IsCompressed(std::string tensor_name) {
+        return format_ != SparseFormat::NONE && this->GetDensity(tensor_name) < 1.0;
+      }
+
+      // Values of the given tensor (in the unit of dense values) to store or move num_values of it, including metadata
+      long GetCompressedSize(std::string tensor_name, long num_values) {
+        return this->GetCompressedSize(tensor_name, num_values, value_bits_);
+      }
+
+      // Same, for values of value_bits bits; the metadata is rounded up to whole values
+      long GetCompressedSize(std::string tensor_name, long num_values, int value_bits) {
+        if(!this->IsCompressed(tensor_name) || num_values <= 0) return num_values;
+
+        long num_nonzeros = static_cast<long>(std::ceil(num_values * this->GetDensity(tensor_name)));
+        long metadata_bits = 0;
+
+        if(format_ == SparseFormat::BITMAP) {
+          metadata_bits = num_values;
+        }
+        else {
+          metadata_bits = num_nonzeros * run_length_bits_;
+        }
+
+        long metadata_size = metadata_bits / value_bits;
+        if(metadata_bits % value_bits != 0) metadata_size++;
+
+        return num_nonzeros + metadata_size;
+      }
+
+      // Fraction of operations whose operands are all non-zero, assuming zeros of different tensors are independent
+      double GetEffectualFraction(const std::list<std::string>& operand_tensors) {
+        double fraction = 1.0;
+
+        for(auto& tensor_name : operand_tensors) {
+          if(this->IsCompressed(tensor_name)) {
+            fraction *= this->GetDensity(tensor_name);
+          }
+        }
+
+        return fraction;
+      }
+
+      /*
+       * Effectual operations of the slowest of num_pes PEs that each receive num_ops operations.
+       * The effectual operations on a PE follow Binomial(num_ops, p); the expected maximum over
+       * num_pes PEs is approximated by mu + sigma * sqrt(2 ln(num_pes)).
+       */
+      long GetMaxEffectualOps(long num_ops, const std::list<std::string>& operand_tensors, long num_pes) {
+        double p = this->GetEffectualFraction(operand_tensors);
+        if(p >= 1.0 || num_ops <= 0) return num_ops;
+
+        double mean = static_cast<double>(num_ops) * p;
+        double stddev = std::sqrt(static_cast<double>(num_ops) * p * (1.0 - p));
+        double imbalance = (num_pes > 1)? stddev * std::sqrt(2.0 * std::log(static_cast<double>(num_pes))) : 0.0;
+
+        long max_ops = static_cast<long>(std::ceil(mean + imbalance));
+
+        return std::max(1L, std::min(num_ops, max_ops));
+      }
+  }; // End of class SparsityModel
+
+}; // End of namespace maestro
+#endif
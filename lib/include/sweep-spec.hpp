@@ -0,0 +1,203 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#ifndef MAESTRO_SWEEP_SPEC_HPP_
+#define MAESTRO_SWEEP_SPEC_HPP_
+
+#include <string>
+#include <vector>
+
+#include "checked-arithmetic.hpp"
+
+namespace maestro {
+
+  const std::string tkn_sweep_map = "Map";
+  const std::string tkn_sweep_param = "Param";
+  const std::string tkn_sweep_constraint = "Constraint";
+  const std::string tkn_sweep_list = "list";
+  const std::string tkn_sweep_range = "range";
+  const std::string tkn_sweep_log = "log";
+
+  enum class SweepTarget {
+    HARDWARE,          // A hardware option, e.g., num_pes
+    MAP_SIZE,          // The size of the map directive of a loop variable
+    DATAFLOW_PARAMETER // A symbolic size of a dataflow template, e.g., Tk
+  };
+
+  enum class SweepKind {
+    LIST,  // The listed values
+    RANGE, // start, start+step, ... up to end
+    LOG    // start, start*factor, ... up to end
+  };
+
+  enum class ComparisonOp {
+    LT,
+    LE,
+    GT,
+    GE,
+    EQ,
+    NE
+  };
+
+  /*
+   * Values of one swept parameter: a hardware option (e.g., num_pes), the size of the map
+   * directive of a loop variable in the dataflow, or a parameter of a dataflow template. Values are computed on demand, so long
+   * ranges cost no memory.
+   */
+  class SweepDimension {
+    protected:
+      std::string name_;
+      SweepTarget target_;
+      SweepKind kind_;
+
+      std::vector<long> values_;
+      long start_;
+      long step_;
+      long num_values_;
+
+    public:
+      SweepDimension(std::string name, SweepTarget target, std::vector<long> values) :
+        name_(name),
+        target_(target),
+        kind_(SweepKind::LIST),
+        values_(values),
+        start_(0),
+        step_(0),
+        num_values_(values.size())
+      {
+      }
+
+      // Requires step > 0 for a range and step > 1 for a log-scale grid
+      SweepDimension(std::string name, SweepTarget target, SweepKind kind, long start, long end, long step) :
+        name_(name),
+        target_(target),
+        kind_(kind),
+        start_(start),
+        step_(step),
+        num_values_(0)
+      {
+        if(kind == SweepKind::RANGE) {
+          num_values_ = (end >= start)? (end - start) / step + 1 : 0;
+        }
+        else {
+          for(long value = start; value > 0 && value <= end; value *= step) {
+            num_values_++;
+            if(value > end / step) break; // The next value would pass end (or overflow)
+          }
+        }
+      }
+
+      std::string GetName() const {
+        return name_;
+      }
+
+      SweepTarget GetTarget() const {
+        return target_;
+      }
+
+      long GetNumValues() const {
+        return num_values_;
+      }
+
+      long GetValue(long value_id) const {
+        switch(kind_) {
+          case SweepKind::LIST:
+            return values_[value_id];
+          case SweepKind::RANGE:
+            return start_ + value_id * step_;
+          default: {
+            long value = start_;
+            for(long idx = 0; idx < value_id; idx++) {
+              value *= step_;
+            }
+            return value;
+          }
+        }
+      }
+  }; // End of class SweepDimension
+
+  // lhs op rhs, where each side is a parameter, a metric of the analysis, or a number
+  class SweepConstraint {
+    public:
+      std::string lhs;
+      ComparisonOp op;
+      std::string rhs;
+
+      static bool Compare(double lhs_value, ComparisonOp op, double rhs_value) {
+        switch(op) {
+          case ComparisonOp::LT: return lhs_value < rhs_value;
+          case ComparisonOp::LE: return lhs_value <= rhs_value;
+          case ComparisonOp::GT: return lhs_value > rhs_value;
+          case ComparisonOp::GE: return lhs_value >= rhs_value;
+          case ComparisonOp::EQ: return lhs_value == rhs_value;
+          default: return lhs_value != rhs_value;
+        }
+      }
+  }; // End of class SweepConstraint
+
+  /*
+   * The cross product of the dimensions. Points are numbered in mixed radix (the last dimension
+   * changes fastest), so any point is generated from its number alone and workers can take
+   * disjoint ranges of numbers without materializing the space.
+   */
+  class SweepSpec {
+    protected:
+      std::vector<SweepDimension> dimensions_;
+      std::vector<SweepConstraint> constraints_;
+
+    public:
+      void AddDimension(SweepDimension dimension) {
+        dimensions_.push_back(dimension);
+      }
+
+      void AddConstraint(SweepConstraint constraint) {
+        constraints_.push_back(constraint);
+      }
+
+      const std::vector<SweepDimension>& GetDimensions() const {
+        return dimensions_;
+      }
+
+      const std::vector<SweepConstraint>& GetConstraints() const {
+        return constraints_;
+      }
+
+      // Throws ArithmeticOverflow if the space has more than 2^63 points
+      long GetNumPoints() const {
+        long num_points = 1;
+        for(auto& dimension : dimensions_) {
+          num_points = CheckedMul(num_points, dimension.GetNumValues());
+        }
+        return num_points;
+      }
+
+      // values[d] is the value of dimension d at the point
+      void GetPoint(long point_id, std::vector<long>& values) const {
+        values.resize(dimensions_.size());
+        for(int dim_id = static_cast<int>(dimensions_.size()) - 1; dim_id >= 0; dim_id--) {
+          long num_values = dimensions_[dim_id].GetNumValues();
+          values[dim_id] = dimensions_[dim_id].GetValue(point_id % num_values);
+          point_id /= num_values;
+        }
+      }
+  }; // End of class SweepSpec
+
+}; // End of namespace maestro
+
+#endif
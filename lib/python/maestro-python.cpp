@@ -0,0 +1,506 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+/*
+ * Python extension module over the analysis library.
+ *
+ *   import maestro
+ *   ctx = maestro.Context(dataflow_text, layer_text)
+ *   ctx.evaluate(num_pes=..., noc_bw=..., noc_hops=..., map_sizes=..., runtime=..., energy=...)
+ *
+ * Design points and results are exchanged through the buffer protocol (e.g., NumPy arrays),
+ * so inputs are read and results are written in place. The GIL is released while the
+ * points are evaluated on native threads.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <exception>
+
+#include "parser.hpp"
+#include "analysis-structure.hpp"
+#include "noc-model.hpp"
+#include "layer-analysis.hpp"
+#include "evaluation-arena.hpp"
+
+namespace maestro {
+namespace python {
+
+  // A one- or two-dimensional C-contiguous buffer of numbers
+  class BufferView {
+    protected:
+      Py_buffer view_;
+      bool acquired_;
+      char format_;
+
+    public:
+      BufferView() :
+        acquired_(false),
+        format_(0)
+      {
+      }
+
+      ~BufferView() {
+        if(acquired_) {
+          PyBuffer_Release(&view_);
+        }
+      }
+
+      bool Acquire(PyObject* obj, bool writable, const char* name) {
+        int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable? PyBUF_WRITABLE : 0);
+        if(PyObject_GetBuffer(obj, &view_, flags) != 0) {
+          return false;
+        }
+        acquired_ = true;
+
+        const char* format = (view_.format == nullptr)? "B" : view_.format;
+        if(*format == '@' || *format == '=' || *format == '<' || *format == '>' || *format == '!') {
+          format++;
+        }
+        format_ = *format;
+
+        if(std::string("bBhHiIlLqQfd").find(format_) == std::string::npos || format[1] != '\0') {
+          PyErr_Format(PyExc_TypeError, "%s must hold integers or floating-point numbers", name);
+          return false;
+        }
+
+        return true;
+      }
+
+      bool IsAcquired() {
+        return acquired_;
+      }
+
+      int GetNumDimensions() {
+        return view_.ndim;
+      }
+
+      Py_ssize_t GetLength() {
+        return view_.len / view_.itemsize;
+      }
+
+      Py_ssize_t GetShape(int dim) {
+        return (dim < view_.ndim)? view_.shape[dim] : 1;
+      }
+
+      long GetInteger(Py_ssize_t idx) {
+        return static_cast<long>(this->GetNumber(idx));
+      }
+
+      double GetNumber(Py_ssize_t idx) {
+        char* ptr = static_cast<char*>(view_.buf) + idx * view_.itemsize;
+        switch(format_) {
+          case 'b': return *reinterpret_cast<signed char*>(ptr);
+          case 'B': return *reinterpret_cast<unsigned char*>(ptr);
+          case 'h': return *reinterpret_cast<short*>(ptr);
+          case 'H': return *reinterpret_cast<unsigned short*>(ptr);
+          case 'i': return *reinterpret_cast<int*>(ptr);
+          case 'I': return *reinterpret_cast<unsigned int*>(ptr);
+          case 'l': return *reinterpret_cast<long*>(ptr);
+          case 'L': return *reinterpret_cast<unsigned long*>(ptr);
+          case 'q': return *reinterpret_cast<long long*>(ptr);
+          case 'Q': return *reinterpret_cast<unsigned long long*>(ptr);
+          case 'f': return *reinterpret_cast<float*>(ptr);
+          default: return *reinterpret_cast<double*>(ptr);
+        }
+      }
+
+      void SetNumber(Py_ssize_t idx, double value) {
+        char* ptr = static_cast<char*>(view_.buf) + idx * view_.itemsize;
+        switch(format_) {
+          case 'b': *reinterpret_cast<signed char*>(ptr) = static_cast<signed char>(value); break;
+          case 'B': *reinterpret_cast<unsigned char*>(ptr) = static_cast<unsigned char>(value); break;
+          case 'h': *reinterpret_cast<short*>(ptr) = static_cast<short>(value); break;
+          case 'H': *reinterpret_cast<unsigned short*>(ptr) = static_cast<unsigned short>(value); break;
+          case 'i': *reinterpret_cast<int*>(ptr) = static_cast<int>(value); break;
+          case 'I': *reinterpret_cast<unsigned int*>(ptr) = static_cast<unsigned int>(value); break;
+          case 'l': *reinterpret_cast<long*>(ptr) = static_cast<long>(value); break;
+          case 'L': *reinterpret_cast<unsigned long*>(ptr) = static_cast<unsigned long>(value); break;
+          case 'q': *reinterpret_cast<long long*>(ptr) = static_cast<long long>(value); break;
+          case 'Q': *reinterpret_cast<unsigned long long*>(ptr) = static_cast<unsigned long long>(value); break;
+          case 'f': *reinterpret_cast<float*>(ptr) = static_cast<float>(value); break;
+          default: *reinterpret_cast<double*>(ptr) = value; break;
+        }
+      }
+  }; // End of class BufferView
+
+  class DesignPoint {
+    public:
+      int num_pes = 1;
+      int noc_bw = 1;
+      int noc_hops = 1;
+      int noc_hop_latency = 1;
+      bool noc_multicast = true;
+      int num_alus_per_pe = 1;
+      std::vector<int> map_sizes; // Empty: sizes of the dataflow description
+  }; // End of class DesignPoint
+
+  class PointResult {
+    public:
+      bool valid = false;
+      long runtime = -1;
+      double energy = -1.0;
+      long l1_buffer_requirement = -1;
+      long l2_buffer_requirement = -1;
+  }; // End of class PointResult
+
+  /*
+   * Parsed dataflow and layer shared by every design point. The tables are only read during evaluation,
+   * so points can be evaluated concurrently.
+   */
+  class EvaluationContext {
+    protected:
+      std::shared_ptr<PragmaTable> pragma_table_;
+      std::shared_ptr<LoopInfoTable> loop_info_table_;
+
+    public:
+      EvaluationContext(std::string dataflow_text, std::string layer_text) {
+        PragmaParser prag_parser(std::make_shared<std::istringstream>(dataflow_text));
+        auto dataflow = prag_parser.ParseTemplate();
+
+        ProblemParser prob_parser(std::make_shared<std::istringstream>(layer_text));
+        loop_info_table_ = prob_parser.ParseProblem();
+
+        // Sz() sizes resolve against the layer; a template with named parameters leaves the context invalid
+        try {
+          pragma_table_ = dataflow->Bind({}, loop_info_table_);
+        }
+        catch(std::runtime_error& e) {
+          pragma_table_ = std::make_shared<PragmaTable>();
+        }
+      }
+
+      bool IsValid() {
+        return (pragma_table_->begin() != pragma_table_->end()) && (loop_info_table_->begin() != loop_info_table_->end());
+      }
+
+      // Loop variables of the temporal and spatial maps, in the order of map_sizes columns
+      std::vector<std::string> GetMapVariables() {
+        std::vector<std::string> map_vars;
+        for(auto pragma : *pragma_table_) {
+          if(pragma.GetClass() == PragmaClass::TEMPORAL_MAP || pragma.GetClass() == PragmaClass::SPATIAL_MAP) {
+            map_vars.push_back(pragma.GetVarName());
+          }
+        }
+        return map_vars;
+      }
+
+      /*
+       * A copy of the dataflow with new map sizes. Maps whose offset equals their size (non-overlapping)
+       * keep the offset equal to the new size; others keep their offset.
+       */
+      std::shared_ptr<PragmaTable> CreatePragmaTable(std::vector<int>& map_sizes) {
+        auto new_table = std::make_shared<PragmaTable>();
+
+        int map_id = 0;
+        for(auto pragma : *pragma_table_) {
+          auto cls = pragma.GetClass();
+          if(cls != PragmaClass::TEMPORAL_MAP && cls != PragmaClass::SPATIAL_MAP) {
+            new_table->AddPragma(pragma);
+            continue;
+          }
+
+          int size = map_sizes[map_id];
+          int ofs = (pragma.GetOffset() == pragma.GetSize())? size : pragma.GetOffset();
+          if(cls == PragmaClass::TEMPORAL_MAP) {
+            new_table->AddPragma(std::make_shared<TemporalMap>(pragma.GetVarName(), size, ofs));
+          }
+          else {
+            new_table->AddPragma(std::make_shared<SpatialMap>(pragma.GetVarName(), size, ofs));
+          }
+          map_id++;
+        }
+
+        return new_table;
+      }
+
+      PointResult Evaluate(DesignPoint& point) {
+        PointResult result;
+
+        if(point.num_pes <= 0 || point.noc_bw <= 0 || point.num_alus_per_pe <= 0) return result;
+        for(auto& map_size : point.map_sizes) {
+          if(map_size <= 0) return result;
+        }
+
+        try {
+          auto pragma_table = point.map_sizes.empty()? pragma_table_ : this->CreatePragmaTable(point.map_sizes);
+          auto noc_model = std::make_shared<NetworkOnChipModel>(point.noc_bw, point.noc_hops, point.noc_hop_latency, point.noc_multicast);
+
+          // Each worker thread evaluates one point at a time, so the arena can be recycled here
+          auto& arena = EvaluationArena::GetThreadArena();
+          arena.Reset();
+
+          LayerAnalysis layer(pragma_table, loop_info_table_, noc_model, point.num_pes);
+          layer.SetMemoryResource(arena.GetResource());
+          layer.SetNumALUsPerPE(point.num_alus_per_pe);
+          layer.Analyze();
+          if(!layer.IsValid()) return result;
+
+          result.runtime = layer.GetRuntime();
+          result.energy = layer.GetEnergy();
+          result.l1_buffer_requirement = layer.GetL1BufferRequirement();
+          result.l2_buffer_requirement = layer.GetL2BufferRequirement();
+          result.valid = true;
+        }
+        catch(std::exception& e) {
+          result.valid = false;
+        }
+
+        return result;
+      }
+  }; // End of class EvaluationContext
+
+}; // End of namespace python
+}; // End of namespace maestro
+
+typedef struct {
+  PyObject_HEAD
+  maestro::python::EvaluationContext* context;
+} ContextObject;
+
+// Context is a heap type, so each instance holds a reference to it
+static void Context_dealloc(ContextObject* self) {
+  PyTypeObject* type = Py_TYPE(self);
+  delete self->context;
+  type->tp_free(reinterpret_cast<PyObject*>(self));
+  Py_DECREF(type);
+}
+
+static int Context_init(ContextObject* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"dataflow", "layer", nullptr};
+  const char* dataflow_text = nullptr;
+  const char* layer_text = nullptr;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwargs, "ss", const_cast<char**>(kwlist), &dataflow_text, &layer_text)) {
+    return -1;
+  }
+
+  delete self->context;
+  self->context = new maestro::python::EvaluationContext(dataflow_text, layer_text);
+
+  if(!self->context->IsValid()) {
+    PyErr_SetString(PyExc_ValueError, "the dataflow or the layer description is empty");
+    return -1;
+  }
+
+  return 0;
+}
+
+// A Context created without __init__ (or whose __init__ failed) has nothing to evaluate
+static bool CheckContext(ContextObject* self) {
+  if(self->context == nullptr || !self->context->IsValid()) {
+    PyErr_SetString(PyExc_RuntimeError, "the context is not initialized with a dataflow and a layer");
+    return false;
+  }
+  return true;
+}
+
+static PyObject* Context_map_variables(ContextObject* self, PyObject* Py_UNUSED(ignored)) {
+  if(!CheckContext(self)) return nullptr;
+
+  auto map_vars = self->context->GetMapVariables();
+
+  PyObject* ret = PyList_New(static_cast<Py_ssize_t>(map_vars.size()));
+  if(ret == nullptr) return nullptr;
+
+  for(size_t idx = 0; idx < map_vars.size(); idx++) {
+    PyList_SET_ITEM(ret, static_cast<Py_ssize_t>(idx), PyUnicode_FromString(map_vars[idx].c_str()));
+  }
+
+  return ret;
+}
+
+static PyObject* Context_evaluate(ContextObject* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"num_pes", "noc_bw", "noc_hops", "runtime", "energy",
+                                 "map_sizes", "l1_buffer", "l2_buffer",
+                                 "num_alus_per_pe", "noc_hop_latency", "noc_multicast", "num_threads", nullptr};
+
+  PyObject* num_pes_obj = nullptr;
+  PyObject* noc_bw_obj = nullptr;
+  PyObject* noc_hops_obj = nullptr;
+  PyObject* runtime_obj = nullptr;
+  PyObject* energy_obj = nullptr;
+  PyObject* map_sizes_obj = Py_None;
+  PyObject* l1_obj = Py_None;
+  PyObject* l2_obj = Py_None;
+  int num_alus_per_pe = 1;
+  int noc_hop_latency = 1;
+  int noc_multicast = 1;
+  int num_threads = 0;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOO|OOOiipi", const_cast<char**>(kwlist),
+                                  &num_pes_obj, &noc_bw_obj, &noc_hops_obj, &runtime_obj, &energy_obj,
+                                  &map_sizes_obj, &l1_obj, &l2_obj,
+                                  &num_alus_per_pe, &noc_hop_latency, &noc_multicast, &num_threads)) {
+    return nullptr;
+  }
+
+  if(!CheckContext(self)) return nullptr;
+
+  maestro::python::BufferView num_pes, noc_bw, noc_hops, runtime, energy, map_sizes, l1_buffer, l2_buffer;
+
+  if(!num_pes.Acquire(num_pes_obj, false, "num_pes")) return nullptr;
+  if(!noc_bw.Acquire(noc_bw_obj, false, "noc_bw")) return nullptr;
+  if(!noc_hops.Acquire(noc_hops_obj, false, "noc_hops")) return nullptr;
+  if(!runtime.Acquire(runtime_obj, true, "runtime")) return nullptr;
+  if(!energy.Acquire(energy_obj, true, "energy")) return nullptr;
+  if(map_sizes_obj != Py_None && !map_sizes.Acquire(map_sizes_obj, false, "map_sizes")) return nullptr;
+  if(l1_obj != Py_None && !l1_buffer.Acquire(l1_obj, true, "l1_buffer")) return nullptr;
+  if(l2_obj != Py_None && !l2_buffer.Acquire(l2_obj, true, "l2_buffer")) return nullptr;
+
+  Py_ssize_t num_points = num_pes.GetLength();
+  if(noc_bw.GetLength() != num_points || noc_hops.GetLength() != num_points
+     || runtime.GetLength() != num_points || energy.GetLength() != num_points
+     || (l1_buffer.IsAcquired() && l1_buffer.GetLength() != num_points)
+     || (l2_buffer.IsAcquired() && l2_buffer.GetLength() != num_points)) {
+    PyErr_SetString(PyExc_ValueError, "every array needs one entry per design point");
+    return nullptr;
+  }
+
+  auto context = self->context;
+  Py_ssize_t num_maps = context->GetMapVariables().size();
+  if(map_sizes.IsAcquired() && (map_sizes.GetNumDimensions() != 2 || map_sizes.GetShape(0) != num_points || map_sizes.GetShape(1) != num_maps)) {
+    PyErr_Format(PyExc_ValueError, "map_sizes must have the shape (%zd, %zd)", num_points, num_maps);
+    return nullptr;
+  }
+
+  if(num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads = static_cast<int>(std::min<Py_ssize_t>(num_threads, std::max<Py_ssize_t>(num_points, 1)));
+
+  Py_ssize_t num_invalid = 0;
+
+  Py_BEGIN_ALLOW_THREADS
+
+  std::vector<Py_ssize_t> invalid_per_thread(num_threads, 0);
+
+  auto evaluate_range = [&](int thread_id, Py_ssize_t begin, Py_ssize_t end) {
+    for(Py_ssize_t idx = begin; idx < end; idx++) {
+      maestro::python::DesignPoint point;
+      point.num_pes = static_cast<int>(num_pes.GetInteger(idx));
+      point.noc_bw = static_cast<int>(noc_bw.GetInteger(idx));
+      point.noc_hops = static_cast<int>(noc_hops.GetInteger(idx));
+      point.noc_hop_latency = noc_hop_latency;
+      point.noc_multicast = (noc_multicast != 0);
+      point.num_alus_per_pe = num_alus_per_pe;
+      if(map_sizes.IsAcquired()) {
+        for(Py_ssize_t map_id = 0; map_id < num_maps; map_id++) {
+          point.map_sizes.push_back(static_cast<int>(map_sizes.GetInteger(idx * num_maps + map_id)));
+        }
+      }
+
+      auto result = context->Evaluate(point);
+      if(!result.valid) invalid_per_thread[thread_id]++;
+
+      runtime.SetNumber(idx, result.runtime);
+      energy.SetNumber(idx, result.energy);
+      if(l1_buffer.IsAcquired()) l1_buffer.SetNumber(idx, result.l1_buffer_requirement);
+      if(l2_buffer.IsAcquired()) l2_buffer.SetNumber(idx, result.l2_buffer_requirement);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  Py_ssize_t chunk_size = (num_points + num_threads - 1) / num_threads;
+  for(int thread_id = 1; thread_id < num_threads; thread_id++) {
+    Py_ssize_t begin = std::min(num_points, thread_id * chunk_size);
+    Py_ssize_t end = std::min(num_points, begin + chunk_size);
+    workers.emplace_back(evaluate_range, thread_id, begin, end);
+  }
+  evaluate_range(0, 0, std::min(num_points, chunk_size));
+
+  for(auto& worker : workers) {
+    worker.join();
+  }
+
+  for(auto& count : invalid_per_thread) {
+    num_invalid += count;
+  }
+
+  Py_END_ALLOW_THREADS
+
+  return PyLong_FromSsize_t(num_invalid);
+}
+
+static PyMethodDef Context_methods[] = {
+  {"map_variables", reinterpret_cast<PyCFunction>(Context_map_variables), METH_NOARGS,
+   "Loop variables of the temporal and spatial maps, in the order of the map_sizes columns"},
+  {"evaluate", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(Context_evaluate)), METH_VARARGS | METH_KEYWORDS,
+   "evaluate(num_pes, noc_bw, noc_hops, runtime, energy, map_sizes=None, l1_buffer=None, l2_buffer=None,\n"
+   "         num_alus_per_pe=1, noc_hop_latency=1, noc_multicast=True, num_threads=0)\n"
+   "Evaluates one design point per entry of num_pes/noc_bw/noc_hops (and per row of map_sizes)\n"
+   "and writes the results into runtime, energy, l1_buffer and l2_buffer in place.\n"
+   "Invalid points get -1. Returns the number of invalid points."},
+  {nullptr, nullptr, 0, nullptr}
+};
+
+static PyType_Slot Context_slots[] = {
+  {Py_tp_doc, const_cast<char*>("Context(dataflow, layer): a parsed dataflow and layer description")},
+  {Py_tp_new, reinterpret_cast<void*>(PyType_GenericNew)},
+  {Py_tp_init, reinterpret_cast<void*>(Context_init)},
+  {Py_tp_dealloc, reinterpret_cast<void*>(Context_dealloc)},
+  {Py_tp_methods, Context_methods},
+  {0, nullptr}
+};
+
+static PyType_Spec Context_spec = {
+  "maestro.Context",
+  sizeof(ContextObject),
+  0,
+  Py_TPFLAGS_DEFAULT,
+  Context_slots
+};
+
+static PyModuleDef maestro_module = {
+  PyModuleDef_HEAD_INIT,
+  "maestro",
+  "Analytical cost model of DNN dataflows",
+  -1,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr
+};
+
+PyMODINIT_FUNC PyInit_maestro(void) {
+  PyObject* context_type = PyType_FromSpec(&Context_spec);
+  if(context_type == nullptr) return nullptr;
+
+  PyObject* module = PyModule_Create(&maestro_module);
+  if(module == nullptr) {
+    Py_DECREF(context_type);
+    return nullptr;
+  }
+
+  if(PyModule_AddObject(module, "Context", context_type) < 0) {
+    Py_DECREF(context_type);
+    Py_DECREF(module);
+    return nullptr;
+  }
+
+  return module;
+}
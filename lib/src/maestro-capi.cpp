@@ -0,0 +1,315 @@
+/******************************************************************************
+Copyright (c) 2018 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <exception>
+
+#include "maestro-capi.h"
+
+#include "parser.hpp"
+#include "analysis-structure.hpp"
+#include "noc-model.hpp"
+#include "dram-model.hpp"
+#include "sparsity-model.hpp"
+#include "layer-analysis.hpp"
+#include "batch-evaluator.hpp"
+#include "evaluation-arena.hpp"
+
+struct maestro_context {
+  std::shared_ptr<maestro::PragmaTable> pragma_table;
+  std::shared_ptr<maestro::LoopInfoTable> loop_info_table;
+
+  maestro_hw_config config;
+  std::string last_error;
+};
+
+namespace {
+
+  int SetError(maestro_context* context, int status, std::string message) {
+    context->last_error = message;
+    return status;
+  }
+
+  // The status of a layer that Analyze() left invalid
+  int SetInvalidPointError(maestro_context* context, maestro::LayerAnalysis& layer) {
+    if(layer.GetMetrics().error == maestro::LayerAnalysisError::NOT_ENOUGH_PES) {
+      return SetError(context, MAESTRO_ERROR_ANALYSIS,
+                      "not enough PEs for the dataflow (minimum " + std::to_string(layer.GetMinNumPEs()) + ")");
+    }
+    return SetError(context, MAESTRO_ERROR_OVERFLOW, "sizes of the design point exceed 64-bit arithmetic");
+  }
+
+  maestro::SparseFormat GetSparseFormat(int sparse_format) {
+    switch(sparse_format) {
+      case MAESTRO_SPARSE_FORMAT_BITMAP:
+        return maestro::SparseFormat::BITMAP;
+      case MAESTRO_SPARSE_FORMAT_RLE:
+        return maestro::SparseFormat::RLE;
+      default:
+        return maestro::SparseFormat::NONE;
+    }
+  }
+
+  maestro::ReductionNetwork GetReductionNetwork(int reduction_network) {
+    switch(reduction_network) {
+      case MAESTRO_REDUCTION_NETWORK_TREE:
+        return maestro::ReductionNetwork::TREE;
+      case MAESTRO_REDUCTION_NETWORK_CHAIN:
+        return maestro::ReductionNetwork::CHAIN;
+      default:
+        return maestro::ReductionNetwork::L2;
+    }
+  }
+
+  maestro::LayerAnalysis CreateLayerAnalysis(maestro_context* context) {
+    auto& config = context->config;
+
+    auto noc_model = std::make_shared<maestro::NetworkOnChipModel>(config.noc_bw, config.noc_hops, config.noc_hop_latency, config.noc_multicast != 0);
+
+    std::shared_ptr<maestro::OffChipMemoryModel> dram_model = nullptr;
+    if(config.dram_bw > 0) {
+      dram_model = std::make_shared<maestro::OffChipMemoryModel>(config.dram_bw, config.dram_latency);
+    }
+
+    // Layers live only during one API call, so the objects of the previous evaluation are gone
+    auto& arena = maestro::EvaluationArena::GetThreadArena();
+    arena.Reset();
+
+    maestro::LayerAnalysis layer(context->pragma_table, context->loop_info_table, noc_model, config.num_pes);
+    layer.SetMemoryResource(arena.GetResource());
+    layer.SetNumALUsPerPE(config.num_alus_per_pe);
+    layer.SetOffChipMemory(config.l2_size, dram_model);
+    layer.SetSparseFormat(GetSparseFormat(config.sparse_format));
+    layer.SetReduction(config.do_reduction != 0, config.do_implicit_reduction != 0);
+    layer.SetSynchronization(false, config.latency_hiding != 0);
+    layer.SetPipeline(config.prefetch_depth, config.drain_overlap != 0);
+    layer.SetReductionNetwork(std::make_shared<maestro::ReductionNetworkModel>(GetReductionNetwork(config.reduction_network), config.reduction_bw,
+                                                                               config.reduction_latency, config.reduction_energy));
+
+    return layer;
+  }
+
+  void FillMetrics(const maestro::LayerMetrics& layer_metrics, maestro_metrics* metrics) {
+    metrics->runtime = layer_metrics.runtime;
+    metrics->energy = layer_metrics.energy;
+    metrics->l1_buffer_requirement = layer_metrics.l1_buffer_requirement;
+    metrics->l2_buffer_requirement = layer_metrics.l2_buffer_requirement;
+    metrics->dram_traffic = layer_metrics.dram_traffic;
+    metrics->total_ops = layer_metrics.total_ops;
+    metrics->num_temporal_iterations = layer_metrics.num_temporal_iterations;
+    metrics->num_spatial_foldings = layer_metrics.num_spatial_foldings;
+    metrics->batch_size = layer_metrics.batch_size;
+    metrics->runtime_per_sample = layer_metrics.runtime_per_sample;
+    metrics->energy_per_sample = layer_metrics.energy_per_sample;
+  }
+
+}; // End of anonymous namespace
+
+extern "C" {
+
+int maestro_capi_version(void) {
+  return MAESTRO_CAPI_VERSION;
+}
+
+void maestro_default_hw_config(maestro_hw_config* config) {
+  if(config == nullptr) return;
+
+  config->num_pes = 7;
+  config->num_alus_per_pe = 9;
+
+  config->noc_bw = 32;
+  config->noc_hops = 1;
+  config->noc_hop_latency = 1;
+  config->noc_multicast = 1;
+
+  config->l2_size = 0;
+  config->dram_bw = 0;
+  config->dram_latency = 100;
+
+  config->sparse_format = MAESTRO_SPARSE_FORMAT_NONE;
+
+  config->do_reduction = 1;
+  config->do_implicit_reduction = 1;
+  config->latency_hiding = 1;
+  config->prefetch_depth = 2;
+  config->drain_overlap = 0;
+
+  config->reduction_network = MAESTRO_REDUCTION_NETWORK_L2;
+  config->reduction_bw = 32;
+  config->reduction_latency = 1;
+  config->reduction_energy = 0.5;
+}
+
+maestro_context* maestro_create(const char* dataflow_text, const char* layer_text) {
+  if(dataflow_text == nullptr || layer_text == nullptr) return nullptr;
+
+  try {
+    std::unique_ptr<maestro_context> context(new maestro_context());
+
+    maestro::PragmaParser prag_parser(std::make_shared<std::istringstream>(dataflow_text));
+    auto dataflow = prag_parser.ParseTemplate();
+
+    maestro::ProblemParser prob_parser(std::make_shared<std::istringstream>(layer_text));
+    context->loop_info_table = prob_parser.ParseProblem();
+
+    // Sz() sizes resolve against the layer; named template parameters are not bound and fail here
+    context->pragma_table = dataflow->Bind({}, context->loop_info_table);
+
+    if(!(context->pragma_table->begin() != context->pragma_table->end())
+       || context->loop_info_table->begin() == context->loop_info_table->end()) {
+      return nullptr;
+    }
+
+    maestro_default_hw_config(&context->config);
+
+    return context.release();
+  }
+  catch(...) {
+    return nullptr;
+  }
+}
+
+void maestro_destroy(maestro_context* context) {
+  delete context;
+}
+
+int maestro_set_hw_config(maestro_context* context, const maestro_hw_config* config) {
+  if(context == nullptr) return MAESTRO_ERROR_INVALID_ARGUMENT;
+  if(config == nullptr) return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "config is NULL");
+
+  if(config->num_pes <= 0 || config->num_alus_per_pe <= 0) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "num_pes and num_alus_per_pe must be positive");
+  }
+  if(config->noc_bw <= 0) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "noc_bw must be positive");
+  }
+  if(config->dram_bw < 0 || config->dram_latency < 0) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "dram_bw and dram_latency must be non-negative");
+  }
+  if(config->prefetch_depth <= 0) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "prefetch_depth must be positive");
+  }
+  if(config->reduction_bw <= 0 || config->reduction_latency < 0) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "reduction_bw must be positive and reduction_latency non-negative");
+  }
+
+  context->config = *config;
+  context->last_error.clear();
+
+  return MAESTRO_OK;
+}
+
+int maestro_get_hw_config(maestro_context* context, maestro_hw_config* config) {
+  if(context == nullptr) return MAESTRO_ERROR_INVALID_ARGUMENT;
+  if(config == nullptr) return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "config is NULL");
+
+  *config = context->config;
+
+  return MAESTRO_OK;
+}
+
+int maestro_evaluate(maestro_context* context, maestro_metrics* metrics) {
+  if(context == nullptr) return MAESTRO_ERROR_INVALID_ARGUMENT;
+  if(metrics == nullptr) return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "metrics is NULL");
+
+  try {
+    auto layer = CreateLayerAnalysis(context);
+    layer.Analyze();
+    if(!layer.IsValid()) {
+      *metrics = maestro_metrics();
+      metrics->runtime = -1;
+      return SetInvalidPointError(context, layer);
+    }
+
+    FillMetrics(layer.GetMetrics(), metrics);
+  }
+  catch(std::exception& e) {
+    return SetError(context, MAESTRO_ERROR_ANALYSIS, e.what());
+  }
+
+  context->last_error.clear();
+
+  return MAESTRO_OK;
+}
+
+int maestro_evaluate_noc_batch(maestro_context* context, long num_configs,
+                               const int* noc_bw, const int* noc_hops, const int* noc_hop_latency,
+                               const int* num_alus_per_pe, long* runtime) {
+  if(context == nullptr) return MAESTRO_ERROR_INVALID_ARGUMENT;
+  if(num_configs < 0 || (num_configs > 0 && (noc_bw == nullptr || noc_hops == nullptr || noc_hop_latency == nullptr
+                                             || num_alus_per_pe == nullptr || runtime == nullptr))) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "invalid configuration arrays");
+  }
+
+  try {
+    auto layer = CreateLayerAnalysis(context);
+    layer.Analyze();
+    if(!layer.IsValid()) {
+      return SetInvalidPointError(context, layer);
+    }
+
+    auto terms = layer.GetPerfAnalysis()->GetRunTimeTerms(layer.GetInputTensors(), layer.GetOutputTensors(),
+                                                          context->config.num_pes, context->config.latency_hiding != 0);
+
+    maestro::BatchRuntimeEvaluator evaluator(terms);
+    evaluator.Evaluate(num_configs, noc_bw, noc_hops, noc_hop_latency, num_alus_per_pe, runtime);
+  }
+  catch(std::exception& e) {
+    return SetError(context, MAESTRO_ERROR_ANALYSIS, e.what());
+  }
+
+  context->last_error.clear();
+
+  return MAESTRO_OK;
+}
+
+int maestro_sweep_num_pes(maestro_context* context, long num_points, const int* num_pes, maestro_metrics* metrics) {
+  if(context == nullptr) return MAESTRO_ERROR_INVALID_ARGUMENT;
+  if(num_points < 0 || (num_points > 0 && (num_pes == nullptr || metrics == nullptr))) {
+    return SetError(context, MAESTRO_ERROR_INVALID_ARGUMENT, "invalid PE count arrays");
+  }
+
+  try {
+    auto layer = CreateLayerAnalysis(context);
+    auto sweep = layer.SweepNumPEs(std::vector<int>(num_pes, num_pes + num_points));
+
+    for(long point = 0; point < num_points; point++) {
+      metrics[point] = maestro_metrics();
+      FillMetrics(sweep[point], &metrics[point]);
+    }
+  }
+  catch(std::exception& e) {
+    return SetError(context, MAESTRO_ERROR_ANALYSIS, e.what());
+  }
+
+  context->last_error.clear();
+
+  return MAESTRO_OK;
+}
+
+const char* maestro_last_error(maestro_context* context) {
+  if(context == nullptr) return "context is NULL";
+
+  return context->last_error.c_str();
+}
+
+} // End of extern "C"
@@ -19,27 +19,51 @@ SOFTWARE.
 
 #include <string>
 #include <iostream>
+#include <fstream>
 #include <list>
+#include <vector>
+#include <map>
 #include <memory>
+#include <cctype>
+#include <algorithm>
 
 #include "parser.hpp"
 #include "analysis-structure.hpp"
 #include "mapping-analysis.hpp"
 #include "cost-analysis.hpp"
+#include "lower-bound-analysis.hpp"
+#include "layer-analysis.hpp"
+#include "network-analysis.hpp"
+#include "chiplet-analysis.hpp"
+#include "design-space-sweep.hpp"
+#include "chrome-trace.hpp"
 
 
 namespace maestro {
 
   std::shared_ptr<maestro::PragmaParser> prag_parser;
   std::shared_ptr<maestro::PragmaTable> prag_table;
+  std::shared_ptr<maestro::DataflowTemplate> dataflow_template;
+  std::map<std::string, int> dataflow_bindings;
   std::shared_ptr<maestro::LoopInfoTable> loop_info_table;
   std::shared_ptr<maestro::MappingAnalysis> map_analysis;
   std::shared_ptr<maestro::NetworkOnChipModel> noc_model;
+  std::shared_ptr<maestro::OffChipMemoryModel> dram_model;
+  std::shared_ptr<maestro::SparsityModel> sparsity_model;
+  std::shared_ptr<maestro::ReductionNetworkModel> reduction_model;
 
   std::shared_ptr<maestro::BufferAnalysis> buff_analysis;
   std::shared_ptr<maestro::PerformanceAnalysis> perf_analysis;
 
+  // The runtime of the layer and its phases; computed once by AnalyzeRuntime for every later report
+  maestro::RuntimeBreakdown runtime_breakdown;
+  long layer_runtime = -1;
+
   int num_pes = 1;
+  long l2_size = 0;
+  maestro::SparseFormat sparse_format = maestro::SparseFormat::NONE;
+  int prefetch_depth = 2;
+  bool drain_overlap = false;
 
   std::list<std::string> input_tensors = {"weight", "input"};
   std::list<std::string> output_tensors = {"output"};
@@ -75,6 +99,14 @@ namespace maestro {
   	return map_analysis;
   }
 
+  std::shared_ptr<maestro::OffChipMemoryModel> GetOffChipMemoryModel() {
+  	return dram_model;
+  }
+
+  std::shared_ptr<maestro::SparsityModel> GetSparsityModel() {
+  	return sparsity_model;
+  }
+
 
   void SetNumPEs(int np) {
     num_pes = np;
@@ -84,194 +116,641 @@ namespace maestro {
     noc_model = std::make_shared<maestro::NetworkOnChipModel>(bw, hops, hop_latency, mc);
   }
 
+  void SetupOffChipMemory(long l2_sz, int dram_bw, int dram_latency) {
+    l2_size = l2_sz;
+    if(dram_bw > 0) {
+      dram_model = std::make_shared<maestro::OffChipMemoryModel>(dram_bw, dram_latency);
+    }
+  }
+
+  void UpdateAllTensors() {
+    all_tensors = input_tensors;
+    all_tensors.insert(all_tensors.end(), output_tensors.begin(), output_tensors.end());
+  }
+
+  // Overrides the tensors of the operator in the layer file
   void SetupInputTensors(std::list<std::string>& in_tensors) {
     input_tensors = in_tensors;
-
-    for(auto& tensor : in_tensors) {
-      all_tensors.push_back(tensor);
-    }
+    UpdateAllTensors();
   }
 
   void SetupOutputTensors(std::list<std::string>& out_tensors) {
     output_tensors = out_tensors;
+    UpdateAllTensors();
+  }
 
-    for(auto& tensor : out_tensors) {
-      all_tensors.push_back(tensor);
+  // "weight" -> "Weight"
+  std::string GetTensorDisplayName(std::string tensor_name) {
+    std::string display_name = tensor_name;
+    if(!display_name.empty()) {
+      display_name[0] = std::toupper(display_name[0]);
     }
+    return display_name;
   }
 
-  void ParseInputs(std::string dataflow_file_name, std::string layer_file_name) {
+  // Returns false if the symbolic sizes of the dataflow cannot be bound
+  bool ParseInputs(std::string dataflow_file_name, std::string layer_file_name, std::vector<std::string> dataflow_params) {
     maestro::PragmaParser prag_parser(dataflow_file_name);
-    prag_table = prag_parser.ParsePragmas();
+    dataflow_template = prag_parser.ParseTemplate();
+
+    maestro::ProblemParser prob_parser(layer_file_name);
+    loop_info_table = prob_parser.ParseProblem();
+
+    try {
+      dataflow_bindings = maestro::ParseTemplateBindings(dataflow_params);
+      prag_table = dataflow_template->Bind(dataflow_bindings, loop_info_table);
+    }
+    catch(std::exception& e) {
+      std::cout << "[MAESTRO] Error; " << e.what() << std::endl;
+      return false;
+    }
+
     std::cout<<"\n------[MAESTRO]: Dataflow Information------\n";
     std::cout << prag_table->ToString() << std::endl;
 
-    maestro::ProblemParser prob_parser(layer_file_name);
     std::cout<<"\n------[MAESTRO]: Layer Information------\n";
-    loop_info_table = prob_parser.ParseProblem();
     std::cout << loop_info_table->ToString() << std::endl;
+
+    auto operator_info = loop_info_table->GetOperator();
+    if(operator_info->IsDeclared()) {
+      std::cout << operator_info->ToString() << std::endl;
+    }
+
+    input_tensors = operator_info->GetInputTensors();
+    output_tensors = operator_info->GetOutputTensors();
+    UpdateAllTensors();
+
+    return true;
   }
 
-  void ConfigureProblem() {
-    map_analysis = std::make_shared<maestro::MappingAnalysis>(prag_table, loop_info_table);
-    map_analysis->PreProcess(num_pes);
+  void SetupPipeline(int depth, bool overlap) {
+    if(depth < 1) {
+      std::cout << "[MAESTRO] Warning; the prefetch depth must be at least 1. Modeling PEs without prefetching" << std::endl;
+      depth = 1;
+    }
+    prefetch_depth = depth;
+    drain_overlap = overlap;
+  }
 
-    std::list<std::string> weight_vars = {"K","C","R","S"} ;
-    map_analysis->AddTensor("weight", weight_vars);
+  void SetupReductionNetwork(std::string topology_name, int bw, int latency, double add_energy) {
+    maestro::ReductionNetwork topology;
+    if(!maestro::ParseReductionNetwork(topology_name, topology)) {
+      std::cout << "[MAESTRO] Warning; unknown reduction network " << topology_name << ". Modeling accumulation in L2" << std::endl;
+      topology = maestro::ReductionNetwork::L2;
+    }
+    if(topology != maestro::ReductionNetwork::L2 && (bw <= 0 || latency < 0)) {
+      std::cout << "[MAESTRO] Warning; the reduction network needs a positive bandwidth and a non-negative latency. Modeling accumulation in L2" << std::endl;
+      topology = maestro::ReductionNetwork::L2;
+    }
+    reduction_model = std::make_shared<maestro::ReductionNetworkModel>(topology, bw, latency, add_energy);
+  }
 
-    std::list<std::string> input_vars = {"C","Y","X"} ;
-    map_analysis->AddTensor("input", input_vars);
+  void SetupSparsity(std::string sparse_format_name) {
+    if(sparse_format_name == "bitmap") {
+      sparse_format = maestro::SparseFormat::BITMAP;
+    }
+    else if(sparse_format_name == "rle") {
+      sparse_format = maestro::SparseFormat::RLE;
+    }
+    else {
+      if(sparse_format_name != "none") {
+        std::cout << "[MAESTRO] Warning; unknown sparse format " << sparse_format_name << ". Modeling dense tensors" << std::endl;
+      }
+      sparse_format = maestro::SparseFormat::NONE;
+    }
+  }
 
-    std::list<std::string> output_vars = {"K","Y","X"} ;
-    map_analysis->AddTensor("output", output_vars);
+  bool ConfigureProblem() {
+    if(num_pes < prag_table->GetMinNumPEs()) {
+      std::cout << "[MAESTRO] Error; not enough PEs for the dataflow (minimum " << prag_table->GetMinNumPEs() << ")" << std::endl;
+      return false;
+    }
 
+    map_analysis = std::make_shared<maestro::MappingAnalysis>(prag_table, loop_info_table);
+    map_analysis->PreProcess(num_pes);
+
+    sparsity_model = std::make_shared<maestro::SparsityModel>(sparse_format, loop_info_table->GetTensorDensities());
+    return true;
   }
 
   void AnalyzeHardware() {
     std::cout<<"------[MAESTRO]: Hardware Information------" << std::endl;;
     std::cout<<"Number of PEs: " << num_pes << std::endl;
     std::cout<<"NoC Bandwidth: " << noc_model->GetBandwidth() << std::endl;
+    if(l2_size > 0) {
+      std::cout<<"L2 Buffer Size: " << l2_size << std::endl;
+    }
+    if(dram_model != nullptr) {
+      std::cout<<"DRAM Bandwidth: " << dram_model->GetBandwidth() << std::endl;
+      std::cout<<"DRAM Latency: " << dram_model->GetLatency() << std::endl;
+    }
+    if(sparse_format != maestro::SparseFormat::NONE) {
+      std::cout<<"Sparse format: " << sparsity_model->GetFormatName() << std::endl;
+    }
+    if(reduction_model != nullptr && reduction_model->ReducesInNetwork()) {
+      std::cout<<"Reduction network: " << reduction_model->GetTopologyName() << std::endl;
+    }
     std::cout << std::endl;
   }
 
   void AnalyzeMapping() {
     std::cout << "Per PE mapping size analysis" << std::endl;
-    std::cout << "Num mapped weights: " << map_analysis->GetMappedSize("weight",false, false)
-              << ", Num spatially mapped unique weights: " << map_analysis->GetMappedSize("weight", false, true)
-              << ", Num temporally mapped unique weights " << map_analysis->GetMappedSize("weight", true, false)
-              << ", Num temporally and spatially mapped unique weights " << map_analysis->GetMappedSize("weight", true, true)
-              << std::endl;
-    std::cout << std::endl;
-
-    std::cout << "Num mapped inputs: " << map_analysis->GetMappedSize("input",false, false)
-              << ", Num spatially mapped unique inputs: " << map_analysis->GetMappedSize("input", false, true)
-              << ", Num temporally mapped unique inputs " << map_analysis->GetMappedSize("input", true, false)
-              << ", Num temporally and spatially mapped unique inputs " << map_analysis->GetMappedSize("input", true, true)
-              << std::endl;
-    std::cout << std::endl;
-
-    std::cout << "Num mapped outputs: " << map_analysis->GetMappedSize("output",false, false)
-              << ", Num spatially mapped unique outputs: " << map_analysis->GetMappedSize("output", false, true)
-              << ", Num temporally mapped unique outputs " << map_analysis->GetMappedSize("output", true, false)
-              << ", Num temporally and spatially mapped unique outputs " << map_analysis->GetMappedSize("output", true, true)
-              << std::endl;
-    std::cout << std::endl;
+    for(auto& tensor_name : all_tensors) {
+      std::cout << "Num mapped " << tensor_name << ": " << map_analysis->GetMappedSize(tensor_name, false, false)
+                << ", Num spatially mapped unique " << tensor_name << ": " << map_analysis->GetMappedSize(tensor_name, false, true)
+                << ", Num temporally mapped unique " << tensor_name << " " << map_analysis->GetMappedSize(tensor_name, true, false)
+                << ", Num temporally and spatially mapped unique " << tensor_name << " " << map_analysis->GetMappedSize(tensor_name, true, true)
+                << std::endl;
+      std::cout << std::endl;
+    }
 
-    std::cout << "Spatially reduced outputs per PE in the steady state: " << map_analysis->GetMappedSize("output",false, false) - map_analysis->GetMappedSize("output", true, true) <<std::endl;
+    for(auto& tensor_name : output_tensors) {
+      std::cout << "Spatially reduced " << tensor_name << " per PE in the steady state: " << map_analysis->GetMappedSize(tensor_name, false, false) - map_analysis->GetMappedSize(tensor_name, true, true) <<std::endl;
+    }
     std::cout << std::endl;
   }
 
   void AnalyzeBuffer(bool silent = false) {
     buff_analysis = std::make_shared<maestro::BufferAnalysis>(map_analysis, noc_model, num_pes);
+    buff_analysis->SetPrefetchDepth(prefetch_depth);
+    buff_analysis->SetReductionNetworkModel(reduction_model);
+    buff_analysis->SetL2Capacity(l2_size);
+    buff_analysis->SetSparsityModel(sparsity_model);
 
     if(!silent) {
     	std::cout << "L1 Buffer requirement (per PE): " << buff_analysis->GetL1BufferRequiredSize(all_tensors) << " Bytes" << std::endl;
     	std::cout << "L2 Buffer requirement: " << buff_analysis->GetL2BufferRequiredSize(all_tensors) << " Bytes" << std::endl;
 
-    	std::cout << "L1 Buffer Rd Weight: " << buff_analysis->GetL1BufferRead("weight") << std::endl;
-    	std::cout << "L1 Buffer Rd Input: " << buff_analysis->GetL1BufferRead("input") << std::endl;
-    	std::cout << "L1 Buffer Rd Output: " << buff_analysis->GetL1BufferRead("output") << std::endl;
-
+    	for(auto& tensor_name : all_tensors) {
+    	  std::cout << "L1 Buffer Rd " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetL1BufferRead(tensor_name) << std::endl;
+    	}
     	std::cout << std::endl;
 
-    	std::cout << "L1 Buffer Wr Weight: " << buff_analysis->GetL1BufferWrite("weight", true, true) << std::endl;
-    	std::cout << "L1 Buffer Wr Input: " << buff_analysis->GetL1BufferWrite("input", true, true) << std::endl;
-    	std::cout << "L1 Buffer Wr Output: " << buff_analysis->GetL1BufferWrite("output", true, true) << std::endl;
+    	for(auto& tensor_name : all_tensors) {
+    	  std::cout << "L1 Buffer Wr " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetL1BufferWrite(tensor_name, true, true) << std::endl;
+    	}
+    	std::cout << std::endl;
 
+    	for(auto& tensor_name : all_tensors) {
+    	  std::cout << "L2 Buffer Rd " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetL2BufferRead(tensor_name, true, true) << std::endl;
+    	}
     	std::cout << std::endl;
 
-    	std::cout << "L2 Buffer Rd Weight: " << buff_analysis->GetL2BufferRead("weight", true, true) << std::endl;
-    	std::cout << "L2 Buffer Rd Input: " << buff_analysis->GetL2BufferRead("input", true, true) << std::endl;
-    	std::cout << "L2 Buffer Rd Output: " << buff_analysis->GetL2BufferRead("output", true, true) << std::endl;
+    	for(auto& tensor_name : all_tensors) {
+    	  std::cout << "L2 Buffer Wr " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetL2BufferWrite(tensor_name, true, true) << std::endl;
+    	}
+
+    	if(dram_model != nullptr) {
+    	  std::cout << std::endl;
+
+    	  for(auto& tensor_name : input_tensors) {
+    	    std::cout << "DRAM Rd " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetDRAMRead(tensor_name, all_tensors) << std::endl;
+    	  }
+    	  for(auto& tensor_name : output_tensors) {
+    	    std::cout << "DRAM Rd Partial Sum " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetDRAMPartialSumRead(tensor_name, all_tensors) << std::endl;
+    	    std::cout << "DRAM Wr " << GetTensorDisplayName(tensor_name) << ": " << buff_analysis->GetDRAMWrite(tensor_name, all_tensors) << std::endl;
+    	  }
+    	}
+    }
 
+    std::cout << std::endl;
+  }
 
-    	std::cout << std::endl;
+  double AnalyzeEnergy() {
+    return buff_analysis->GetAccessEnergy(all_tensors);
+  }
 
-    	std::cout << "L2 Buffer Wr Weight: " << buff_analysis->GetL2BufferWrite("weight", true, true) << std::endl;
-    	std::cout << "L2 Buffer Wr Input: " << buff_analysis->GetL2BufferWrite("input", true, true) << std::endl;
-    	std::cout << "L2 Buffer Wr Sum: " << buff_analysis->GetL2BufferWrite("output", true, true) << std::endl;
+  void AnalyzeReuse() {
+    std::cout<<"------[MAESTRO]: Reuse analysis ------" << std::endl;
+    std::cout<<"Total computations (the number of partial sums): " << loop_info_table->GetTotalOps() << std::endl;
+    std::cout<< "" <<std::endl;
+
+    int tensor_id = 1;
+    for(auto& tensor_name : all_tensors) {
+      auto display_name = GetTensorDisplayName(tensor_name);
+      bool is_output = std::find(output_tensors.begin(), output_tensors.end(), tensor_name) != output_tensors.end();
+
+      std::cout << "  " << tensor_id << ". " << display_name << std::endl;
+      std::cout<<"  " << display_name << ((tensor_name == "weight")? ": Total number of values " : ": Total values ") << map_analysis->GetFullSize(tensor_name) << std::endl;
+      if(is_output) {
+        std::cout<<"  " << display_name << ": Spatial reuse factor (Partial sum accumulation via PE-to-PE communication)" << buff_analysis->GetSpatialReuse(tensor_name) << std::endl;
+      }
+      else {
+        std::cout<<"  " << display_name << ": Spatial reuse factor (multicast factor)" << buff_analysis->GetSpatialReuse(tensor_name) << std::endl;
+      }
+      std::cout<<"  " << display_name << ": Temporal reuse factor (The number of temporal reuse per data point)" << buff_analysis->GetTemporalReuse(tensor_name) << std::endl;
+      std::cout<< "" <<std::endl;
+
+      tensor_id++;
     }
 
     std::cout << std::endl;
   }
 
-  double AnalyzeEnergy() {
-    double energy_consumption_ = 0.0;
+  void AnalyzeRuntime(int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true) {
+    perf_analysis = std::make_shared<maestro::PerformanceAnalysis> (map_analysis, buff_analysis, noc_model, do_reduction, do_implicit_reduction, fg_sync);
+    perf_analysis->SetOffChipMemoryModel(dram_model);
+    perf_analysis->SetSparsityModel(sparsity_model);
+    perf_analysis->SetDrainOverlap(drain_overlap);
+
+    runtime_breakdown = maestro::RuntimeBreakdown();
+    layer_runtime = perf_analysis->GetRunTime (input_tensors, output_tensors, num_pes, num_alus_per_pe, latency_hiding, &runtime_breakdown);
+    long runtime = layer_runtime;
+
+    std::cout<<"------[MAESTRO]: Runtime and Energy details------" << std::endl;
+
+      for(auto& tensor_name : all_tensors) {
+        std::cout << "L1 " << GetTensorDisplayName(tensor_name) << " Buffer requirement (per PE): " << buff_analysis->GetL1BufferRequiredSize({tensor_name}) << " Bytes" << std::endl;
+      }
+      std::cout << std::endl;
+
+    long temporal_iterations = map_analysis->GetNumTemporalIterations();
+    long spatial_foldings = map_analysis->GetNumSpatialFoldings();
 
-    double l1_energy = 0.0;
+    std::cout<< "The number of temporal iterations: " << temporal_iterations << std::endl;
+    std::cout<< "The number of spatial foldings: " << spatial_foldings << std::endl;
+    std::cout<< "The number of total iterations: " << maestro::CheckedMul(temporal_iterations, spatial_foldings) << std::endl;
+    std::cout << "Total Runtime: " << runtime << " cycles" << std::endl;
+    std::cout << "Total Energy: " << AnalyzeEnergy()/(float) (maestro::mac_energy) << " times MAC energy" << std::endl;
 
-    l1_energy += buff_analysis->GetL1BufferRead("weight");
-    l1_energy += buff_analysis->GetL1BufferRead("input");
-    l1_energy += buff_analysis->GetL1BufferRead("output");
+    double effectual_fraction = sparsity_model->GetEffectualFraction(input_tensors);
+    if(effectual_fraction < 1.0) {
+      std::cout << "Effectual operations: " << effectual_fraction * 100.0 << " %" << std::endl;
+      std::cout << "Operations per PE (dense): " << perf_analysis->GetNumOpsPerPE() << std::endl;
+      std::cout << "Effectual operations of the slowest PE: " << perf_analysis->GetEffectualNumOpsPerPE(num_pes) << std::endl;
+    }
 
-    l1_energy += buff_analysis->GetL1BufferWrite("weight", true, true);
-    l1_energy += buff_analysis->GetL1BufferWrite("input", true, true);
-    l1_energy += buff_analysis->GetL1BufferWrite("output", true, true);
+    int batch_size = map_analysis->GetBatchSize();
+    auto batch_var = map_analysis->GetOperator()->GetBatchVariable();
+    if(!batch_var.empty() && map_analysis->HasLoop(batch_var)) {
+      std::cout << "Batch size: " << batch_size << std::endl;
+      std::cout << "Runtime per sample: " << static_cast<double>(runtime) / batch_size << " cycles" << std::endl;
+      std::cout << "Energy per sample: " << AnalyzeEnergy()/(float) (maestro::mac_energy) / batch_size << " times MAC energy" << std::endl;
+      std::cout << "Throughput: " << static_cast<double>(batch_size) / runtime << " samples per cycle" << std::endl;
+    }
+  }
 
-    l1_energy *= 2.91;
+  void AnalyzeRoofline(int num_alus_per_pe = 1) {
+    auto roofline = std::make_shared<maestro::RooflineAnalysis>(map_analysis, buff_analysis, noc_model, dram_model,
+                                                                input_tensors, output_tensors, num_pes, num_alus_per_pe);
 
-    double l2_energy = 0.0;
+    std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: Roofline analysis------" << std::endl;
+    std::cout << "L2 Buffer footprint (entire layer): " << buff_analysis->GetL2Footprint(all_tensors) << std::endl;
+    if(l2_size > 0) {
+      std::cout << "L2 Reuse captured: " << buff_analysis->GetL2ReuseRatio(all_tensors) * 100.0 << " %"
+                << (buff_analysis->IsL2Overflowed(all_tensors)? " (L2 overflow)" : "") << std::endl;
+    }
+    std::cout << "Compute-bound runtime: " << roofline->GetComputeBoundDelay() << " cycles" << std::endl;
+    std::cout << "NoC-bound runtime: " << roofline->GetNoCBoundDelay() << " cycles" << std::endl;
+    if(dram_model != nullptr) {
+      std::cout << "DRAM-bound runtime: " << roofline->GetDRAMBoundDelay() << " cycles" << std::endl;
+      std::cout << "DRAM traffic: " << roofline->GetDRAMTraffic() << std::endl;
+      std::cout << "Operational intensity: " << roofline->GetOperationalIntensity() << " ops per DRAM access" << std::endl;
+      std::cout << "Ridge point: " << roofline->GetRidgePoint() << " ops per DRAM access" << std::endl;
+    }
+    std::cout << "Roofline bound: " << roofline->GetBoundName() << std::endl;
+  }
 
-    l2_energy += buff_analysis->GetL2BufferRead("weight");
-    l2_energy += buff_analysis->GetL2BufferRead("input");
-    l2_energy += buff_analysis->GetL2BufferRead("output");
+  void AnalyzeEfficiency(int num_alus_per_pe = 1) {
+    maestro::LowerBoundAnalysis bounds(loop_info_table, noc_model, dram_model, sparsity_model, num_pes, num_alus_per_pe);
 
-    l2_energy += buff_analysis->GetL2BufferWrite("weight", true, true);
-    l2_energy += buff_analysis->GetL2BufferWrite("input", true, true);
-    l2_energy += buff_analysis->GetL2BufferWrite("output", true, true);
+    long runtime = layer_runtime;
+    long l2_read = 0;
+    for(auto& tensor_name : input_tensors) {
+      l2_read = maestro::CheckedAdd(l2_read, buff_analysis->GetL2BufferRead(tensor_name));
+    }
+    long l2_write = 0;
+    for(auto& tensor_name : output_tensors) {
+      l2_write = maestro::CheckedAdd(l2_write, buff_analysis->GetL1ToL2Traffic(tensor_name));
+    }
 
-    l2_energy *= 32.2;
+    long runtime_bound = bounds.GetRuntimeBound();
+    long l2_traffic_bound = bounds.GetL2TrafficBound();
+    double alu_cycles = static_cast<double>(runtime) * num_pes * num_alus_per_pe;
+    double noc_capacity = static_cast<double>(runtime) * noc_model->GetBandwidth();
 
-    return l1_energy + l2_energy;
     std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: Efficiency report------" << std::endl;
+    std::cout << "Runtime lower bound: " << runtime_bound << " cycles (" << bounds.GetBindingResourceName() << ")" << std::endl;
+    std::cout << "Runtime / lower bound: " << static_cast<double>(runtime) / runtime_bound << std::endl;
+    std::cout << "L2 traffic: " << l2_read + l2_write << " (lower bound " << l2_traffic_bound << ")" << std::endl;
+    std::cout << "L2 traffic / lower bound: " << static_cast<double>(l2_read + l2_write) / l2_traffic_bound << std::endl;
+    std::cout << "PE utilization: " << bounds.GetEffectualTotalOps() / alu_cycles * 100.0 << " %" << std::endl;
+    std::cout << "NoC utilization: " << std::max(l2_read, l2_write) / noc_capacity * 100.0 << " %" << std::endl;
+    if(runtime < runtime_bound || l2_read + l2_write < l2_traffic_bound) {
+      std::cout << "[MAESTRO] Warning; the mapping does not cover every operation or value of the layer" << std::endl;
+    }
   }
 
-  void AnalyzeReuse() {
-    std::cout<<"------[MAESTRO]: Reuse analysis ------" << std::endl;
-    std::cout<<"Total computations (the number of partial sums): " << loop_info_table->GetTotalIterations() << std::endl;
-    std::cout<< "" <<std::endl;
+  void AnalyzeBottleneck() {
+    const maestro::RuntimeBreakdown& breakdown = runtime_breakdown;
+    long runtime = layer_runtime;
+    if(runtime <= 0) return;
 
-    std::cout << "  1. Weight" << std::endl;
-    std::cout<<"  Weight: Total number of values " << map_analysis->GetFullSize("weight") << std::endl;
-    std::cout<<"  Weight: Spatial reuse factor (multicast factor)" << buff_analysis->GetSpatialReuse("weight") << std::endl;
-    std::cout<<"  Weight: Temporal reuse factor (The number of temporal reuse per data point)" << buff_analysis->GetTemporalReuse("weight") << std::endl;
-    std::cout<< "" <<std::endl;
+    std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: Bottleneck analysis------" << std::endl;
+    for(auto& phase : breakdown.phases) {
+      if(phase.count == 0) continue;
+
+      std::cout << phase.name << ": " << phase.count << " x " << phase.iteration_delay << " cycles"
+                << " (input NoC " << phase.noc_in_delay << ", output NoC " << phase.noc_out_delay
+                << ", compute " << phase.compute_delay << ", off-chip " << phase.dram_delay << "), "
+                << maestro::GetRuntimeResourceName(phase.bound) << " bound" << std::endl;
+    }
 
-    std::cout << "  2. Input" << std::endl;
-    std::cout<<"  Input: Total values " << map_analysis->GetFullSize("input") << std::endl;
-    std::cout<<"  Input: Spatial reuse factor (multicast factor)" << buff_analysis->GetSpatialReuse("input") << std::endl;
-    std::cout<<"  Input: Temporal reuse factor (The number of temporal reuse per data point)" << buff_analysis->GetTemporalReuse("input") << std::endl;
-    std::cout<< "" <<std::endl;
+    for(auto resource : {maestro::RuntimeResource::NOC_IN, maestro::RuntimeResource::NOC_OUT,
+                         maestro::RuntimeResource::COMPUTE, maestro::RuntimeResource::DRAM}) {
+      long cycles = breakdown.GetBoundCycles(resource);
+      if(cycles == 0) continue;
 
-    std::cout << "  3. Output" << std::endl;
-    std::cout<<"  Output: Total values " << map_analysis->GetFullSize("output") << std::endl;
-    std::cout<<"  Output: Spatial reuse factor (Partial sum accumulation via PE-to-PE communication)" << buff_analysis->GetSpatialReuse("output") << std::endl;
-    std::cout<<"  Output: Temporal reuse factor (The number of temporal reuse per data point)" << buff_analysis->GetTemporalReuse("output") << std::endl;
-    std::cout<< "" <<std::endl;
+      long steady_state_bound_cycles = breakdown.GetBoundCycles(resource, true);
+      std::cout << maestro::GetRuntimeResourceName(resource) << " bound cycles: " << 100.0 * cycles / runtime << " %";
+      if(steady_state_bound_cycles > 0) {
+        std::cout << " (" << 100.0 * steady_state_bound_cycles / runtime << " % in steady temporal and spatial iterations)";
+      }
+      std::cout << std::endl;
+    }
+    std::cout << "Bottleneck: " << maestro::GetRuntimeResourceName(breakdown.GetBottleneck()) << std::endl;
+  }
+
+  void WriteTrace(std::string file_name, std::string layer_name) {
+    if(layer_runtime <= 0) return;
+
+    std::ofstream trace_file(file_name);
+    if(!trace_file.is_open()) {
+      std::cout << "[MAESTRO] Error; cannot open the trace file " << file_name << std::endl;
+      return;
+    }
+
+    maestro::ChromeTraceWriter writer(trace_file);
+    writer.Write(runtime_breakdown, layer_name);
+    std::cout << std::endl << "Wrote the modeled schedule (" << writer.GetNumEvents() << " trace events) to " << file_name << std::endl;
+  }
+
+  void AnalyzePESweep(std::vector<int> num_pes_list, int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true) {
+    maestro::LayerAnalysis layer(prag_table, loop_info_table, noc_model, num_pes);
+    layer.SetNumALUsPerPE(num_alus_per_pe);
+    layer.SetOffChipMemory(l2_size, dram_model);
+    layer.SetSparseFormat(sparse_format);
+    layer.SetReduction(do_reduction, do_implicit_reduction);
+    layer.SetSynchronization(fg_sync, latency_hiding);
+    layer.SetPipeline(prefetch_depth, drain_overlap);
+    layer.SetReductionNetwork(reduction_model);
 
     std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: PE count sweep------" << std::endl;
+    for(auto& point : layer.SweepNumPEs(num_pes_list)) {
+      std::cout << "Number of PEs " << point.num_pes << ": ";
+      if(!point.valid) {
+        if(point.error == maestro::LayerAnalysisError::NOT_ENOUGH_PES) {
+          std::cout << "not enough PEs for the dataflow (minimum " << layer.GetMinNumPEs() << ")" << std::endl;
+        }
+        else {
+          std::cout << "invalid (sizes exceed 64-bit arithmetic)" << std::endl;
+        }
+        continue;
+      }
+
+      std::cout << "Runtime " << point.runtime << " cycles, "
+                << "Energy " << point.energy << " times MAC energy, "
+                << "L1 Buffer requirement " << point.l1_buffer_requirement << " Bytes, "
+                << "L2 Buffer requirement " << point.l2_buffer_requirement << " Bytes, "
+                << "Spatial foldings " << point.num_spatial_foldings << std::endl;
+    }
   }
 
-  void AnalyzeRuntime(int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true) {
-    perf_analysis = std::make_shared<maestro::PerformanceAnalysis> (map_analysis, buff_analysis, noc_model, do_reduction, do_implicit_reduction, fg_sync);
+  void AnalyzeChiplets(int num_chiplets, std::string partition_var, int interchip_bw, int interchip_latency,
+                       int num_alus_per_pe = 1, bool do_reduction = true, bool do_implicit_reduction = true, bool fg_sync = false, bool latency_hiding = true) {
+    if(interchip_bw <= 0) {
+      std::cout << "[MAESTRO] Error; the inter-chip bandwidth must be positive" << std::endl;
+      return;
+    }
 
-    long runtime = perf_analysis->GetRunTime (input_tensors, output_tensors, num_pes, num_alus_per_pe, latency_hiding);
+    auto layer = std::make_shared<maestro::LayerAnalysis>(prag_table, loop_info_table, noc_model, num_pes);
+    layer->SetNumALUsPerPE(num_alus_per_pe);
+    layer->SetOffChipMemory(l2_size, dram_model);
+    layer->SetSparseFormat(sparse_format);
+    layer->SetReduction(do_reduction, do_implicit_reduction);
+    layer->SetSynchronization(fg_sync, latency_hiding);
+    layer->SetPipeline(prefetch_depth, drain_overlap);
+    layer->SetReductionNetwork(reduction_model);
+
+    std::list<std::string> partition_vars;
+    if(partition_var == "all") {
+      for(auto& loop : *loop_info_table) {
+        if(loop->GetNumIter() > 1) {
+          partition_vars.push_back(loop->GetLoopVar());
+        }
+      }
+    }
+    else if(loop_info_table->FindLoop(partition_var) != nullptr) {
+      partition_vars.push_back(partition_var);
+    }
+    else {
+      std::cout << "[MAESTRO] Error; the layer has no loop on " << partition_var << " to partition" << std::endl;
+      return;
+    }
 
-    std::cout<<"------[MAESTRO]: Runtime and Energy details------" << std::endl;
+    std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: Chiplet partitioning------" << std::endl;
+    std::cout << "Number of chiplets: " << num_chiplets << ", Inter-chip bandwidth: " << interchip_bw
+              << " Bytes/cycle, Inter-chip latency: " << interchip_latency << " cycles" << std::endl;
+
+    std::string best_var = "";
+    long best_runtime = -1;
+    for(auto& var : partition_vars) {
+      maestro::ChipletAnalysis chiplets(layer, num_chiplets, var, interchip_bw, interchip_latency);
+      chiplets.Analyze();
+
+      std::cout << "Partition " << var << ": ";
+      if(!chiplets.IsValid()) {
+        std::cout << "invalid (a slice does not fit the dataflow or sizes exceed 64-bit arithmetic)" << std::endl;
+        continue;
+      }
+
+      long runtime = chiplets.GetRuntime();
+      std::cout << "Runtime " << runtime << " cycles "
+                << "(chiplets " << chiplets.GetComputeRuntime()
+                << ", input exchange " << chiplets.GetInputExchangeDelay()
+                << ", cross-chip reduction " << chiplets.GetCrossChipReductionDelay()
+                << ", synchronization " << chiplets.GetSynchronizationDelay() << "), "
+                << "Energy " << chiplets.GetEnergy() << " times MAC energy, "
+                << "Inter-chip traffic " << chiplets.GetInterChipTraffic() << " Bytes, "
+                << "L2 Buffer requirement per chiplet " << chiplets.GetL2BufferRequirement() << " Bytes, "
+                << "Active chiplets " << chiplets.GetNumActiveChiplets() << std::endl;
+
+      if(best_runtime < 0 || runtime < best_runtime) {
+        best_runtime = runtime;
+        best_var = var;
+      }
+    }
 
-      std::cout << "L1 Weight Buffer requirement (per PE): " << buff_analysis->GetL1BufferRequiredSize({"weight"}) << " Bytes" << std::endl;
-      std::cout << "L1 Input Buffer requirement (per PE): " << buff_analysis->GetL1BufferRequiredSize({"input"}) << " Bytes" << std::endl;
-      std::cout << "L1 Output Buffer requirement (per PE): " << buff_analysis->GetL1BufferRequiredSize({"output"}) << " Bytes" << std::endl;
-      std::cout << std::endl;
+    if(partition_vars.size() > 1 && best_runtime >= 0) {
+      std::cout << "Fastest partition: " << best_var << " (" << best_runtime << " cycles)" << std::endl;
+    }
+  }
 
-    long temporal_iterations = map_analysis->GetNumTemporalIterations();
-    long spatial_foldings = map_analysis->GetNumSpatialFoldings();
+  void PrintSweepPoint(maestro::DesignSpaceSweep& sweep, const maestro::SweepPoint& point) {
+    auto& dimensions = sweep.GetSpec()->GetDimensions();
+    std::cout << "point " << point.point_id << " (";
+    for(int dim_id = 0; dim_id < static_cast<int>(dimensions.size()); dim_id++) {
+      auto target = dimensions[dim_id].GetTarget();
+      std::cout << (dim_id == 0? "" : ", ")
+                << (target == maestro::SweepTarget::MAP_SIZE? "Map " : target == maestro::SweepTarget::DATAFLOW_PARAMETER? "Param " : "")
+                << dimensions[dim_id].GetName() << "=" << point.values[dim_id];
+    }
+    std::cout << "): Runtime " << point.metrics.runtime << " cycles, Energy " << point.metrics.energy << " times MAC energy, "
+              << "L1 Buffer requirement " << point.metrics.l1_buffer_requirement << " Bytes, "
+              << "L2 Buffer requirement " << point.metrics.l2_buffer_requirement << " Bytes" << std::endl;
+  }
 
-    std::cout<< "The number of temporal iterations: " << temporal_iterations << std::endl;
-    std::cout<< "The number of spatial foldings: " << spatial_foldings << std::endl;
-    std::cout<< "The number of total iterations: " << temporal_iterations * spatial_foldings << std::endl;
-    std::cout << "Total Runtime: " << runtime << " cycles" << std::endl;
-    std::cout << "Total Energy: " << AnalyzeEnergy()/(float) (1.73) << " times MAC energy" << std::endl;
+  void AnalyzeSweep(Options& option) {
+    maestro::SweepSpecParser spec_parser(option.sweep_file_name);
+    auto spec = spec_parser.ParseSweepSpec();
+
+    std::cout << std::endl;
+    std::cout<<"------[MAESTRO]: Design space sweep------" << std::endl;
+
+    try {
+      maestro::DesignSpaceSweep sweep(spec, dataflow_template, dataflow_bindings, loop_info_table, option);
+
+      std::shared_ptr<std::ofstream> csv = nullptr;
+      if(!option.sweep_output_file_name.empty()) {
+        csv = std::make_shared<std::ofstream>(option.sweep_output_file_name);
+        if(!(*csv)) {
+          std::cout << "[MAESTRO] Error; cannot open " << option.sweep_output_file_name << std::endl;
+          return;
+        }
+        sweep.WriteCSVHeader(*csv);
+      }
+
+      auto summary = sweep.Run(option.sweep_threads, csv.get());
+
+      std::cout << "Design points: " << summary.num_points << std::endl;
+      std::cout << "Pruned by parameter constraints: " << summary.num_pruned << std::endl;
+      std::cout << "Invalid (too few PEs, non-positive sizes, or overflow): " << summary.num_invalid << std::endl;
+      std::cout << "Rejected by metric constraints: " << summary.num_rejected
+                << " (" << summary.num_bounded << " by the runtime lower bound, not analyzed)" << std::endl;
+      std::cout << "Accepted: " << summary.num_accepted << std::endl;
+      std::cout << "Equivalent to an analyzed mapping (not analyzed again): " << summary.num_reused << std::endl;
+
+      if(summary.has_best) {
+        std::cout << "Best runtime: ";
+        PrintSweepPoint(sweep, summary.best_runtime);
+        std::cout << "Best energy: ";
+        PrintSweepPoint(sweep, summary.best_energy);
+      }
+    }
+    catch(maestro::ArithmeticOverflow& e) {
+      std::cout << "[MAESTRO] Error; the sweep has more than 2^63 design points" << std::endl;
+    }
+    catch(std::exception& e) {
+      std::cout << "[MAESTRO] Error; " << e.what() << std::endl;
+    }
+  }
+
+  void AnalyzeNetwork(std::string network_file_name, int num_alus_per_pe = 1) {
+    maestro::NetworkParser net_parser(network_file_name);
+    auto layer_files = net_parser.ParseNetwork();
+
+    if(layer_files.empty()) {
+      std::cout << "[MAESTRO] Error; the network description has no layers" << std::endl;
+      return;
+    }
+
+    auto network_analysis = std::make_shared<maestro::NetworkAnalysis>(noc_model, dram_model, num_pes, num_alus_per_pe, l2_size);
+    network_analysis->SetSparseFormat(sparse_format);
+    network_analysis->SetPipeline(prefetch_depth, drain_overlap);
+    network_analysis->SetReductionNetwork(reduction_model);
+
+    for(auto& layer_file : layer_files) {
+      auto dataflow_file_name = std::get<0>(layer_file);
+      auto layer_file_name = std::get<1>(layer_file);
+
+      maestro::PragmaParser prag_parser(dataflow_file_name);
+      maestro::ProblemParser prob_parser(layer_file_name);
+      auto layer_loop_info_table = prob_parser.ParseProblem();
+
+      // Symbolic sizes of the dataflows can only refer to the sizes of their layers
+      std::shared_ptr<maestro::PragmaTable> layer_prag_table;
+      try {
+        layer_prag_table = prag_parser.ParseTemplate()->Bind({}, layer_loop_info_table);
+      }
+      catch(std::exception& e) {
+        std::cout << "[MAESTRO] Error; " << dataflow_file_name << ": " << e.what() << std::endl;
+        return;
+      }
+
+      network_analysis->AddLayer(layer_file_name, layer_prag_table, layer_loop_info_table);
+    }
+
+    network_analysis->Analyze();
+
+    for(int layer_id = 0; layer_id < network_analysis->GetNumLayers(); layer_id++) {
+      if(!network_analysis->GetLayer(layer_id)->IsValid()) {
+        std::cout << "[MAESTRO] Error; the sizes of layer " << layer_id << " (" << network_analysis->GetLayerName(layer_id)
+                  << ") exceed 64-bit arithmetic" << std::endl;
+        return;
+      }
+    }
+
+    std::cout<<"------[MAESTRO]: Network analysis------" << std::endl;
+    for(int layer_id = 0; layer_id < network_analysis->GetNumLayers(); layer_id++) {
+      auto layer = network_analysis->GetLayer(layer_id);
+      std::cout << "Layer " << layer_id << " (" << network_analysis->GetLayerName(layer_id) << "): "
+                << "Runtime " << layer->GetRuntime() << " cycles, "
+                << "Runtime per sample " << layer->GetRuntimePerSample() << " cycles, "
+                << "L2 Buffer requirement " << layer->GetL2BufferRequirement() << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout<<"------[MAESTRO]: Layer fusion analysis------" << std::endl;
+    for(int layer_id = 0; layer_id + 1 < network_analysis->GetNumLayers(); layer_id++) {
+      std::cout << "Layer " << layer_id << " -> Layer " << layer_id+1 << ": ";
+      if(!network_analysis->IsShapeCompatible(layer_id)) {
+        std::cout << "not fusable (output shape does not match the next input)" << std::endl;
+        continue;
+      }
+
+      std::cout << (network_analysis->CanFuse(layer_id)? "fusable" : "not fusable (exceeds L2)")
+                << ", Fused L2 requirement " << network_analysis->GetFusedL2Requirement(layer_id)
+                << ", Intermediate tile " << network_analysis->GetIntermediateTileSize(layer_id)
+                << ", DRAM traffic saved " << network_analysis->GetFusionDRAMSavings(layer_id)
+                << ", L2 accesses saved " << network_analysis->GetFusionL2Savings(layer_id) << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout<<"------[MAESTRO]: Fusion groups------" << std::endl;
+    int group_id = 0;
+    for(auto& group : network_analysis->GetFusionGroups()) {
+      std::cout << "Group " << group_id << ": Layers";
+      for(auto& layer_id : group) {
+        std::cout << " " << layer_id;
+      }
+      std::cout << std::endl;
+
+      long sequential_runtime = network_analysis->GetSequentialRuntime(group);
+      std::cout << "  Sequential runtime (entire array per layer): " << sequential_runtime << " cycles" << std::endl;
+
+      if(group.size() > 1) {
+        auto partitions = network_analysis->PartitionPEs(group);
+        long interval = network_analysis->GetPipelinedInterval(group);
+        if(interval < 0) {
+          std::cout << "  Not enough PEs to pipeline the group" << std::endl;
+        }
+        else {
+          std::cout << "  PE partitions:";
+          for(auto& partition : partitions) {
+            std::cout << " " << partition;
+          }
+          std::cout << std::endl;
+          std::cout << "  Pipelined initiation interval: " << interval << " cycles" << std::endl;
+          std::cout << "  Pipelined throughput speedup: " << static_cast<double>(sequential_runtime) / interval << std::endl;
+        }
+      }
+      group_id++;
+    }
   }
 
 } //End of namespace maestro
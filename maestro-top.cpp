@@ -23,7 +23,9 @@ SOFTWARE.
 #include<boost/program_options.hpp>
 
 #include "analysis-structure.hpp"
+#include "checked-arithmetic.hpp"
 #include "option.hpp"
+#include "evaluation-server.hpp"
 #include "parser.hpp"
 
 #include "maestro.hpp"
@@ -38,23 +40,67 @@ int main(int argc, char** argv)
 
   if(!success) {
     std::cout << "[MAESTRO] Failed to parse program options" << std::endl;
+    return 1;
   }
 
-  std::list<std::string> in_tensors = {"weight", "input"};
-  std::list<std::string> out_tensors = {"output"};
-
-
   maestro::SetNumPEs(option.np);
   maestro::SetupNoC(option.bw, option.hops, option.hop_latency, option.mc);
-  maestro::SetupInputTensors(in_tensors);
-  maestro::SetupOutputTensors(out_tensors);
-  maestro::ParseInputs(option.dataflow_file_name, option.layer_file_name);
-  maestro::ConfigureProblem();
-
-  maestro::AnalyzeHardware();
-  maestro::AnalyzeBuffer(true);
-  maestro::AnalyzeReuse();
-  maestro::AnalyzeRuntime(option.num_alus_per_pe, option.do_reduction, option.do_implicit_reduction, option.fg_sync);
+  maestro::SetupOffChipMemory(option.l2_size, option.dram_bw, option.dram_latency);
+  maestro::SetupSparsity(option.sparse_format);
+  maestro::SetupPipeline(option.prefetch_depth, option.drain_overlap);
+  maestro::SetupReductionNetwork(option.reduction_network, option.reduction_bw, option.reduction_latency, option.reduction_energy);
+
+  if(option.server || !option.server_socket.empty()) {
+    maestro::EvaluationServer server(option, option.server_threads);
+    if(!option.server_socket.empty()) {
+      return server.ServeSocket(option.server_socket);
+    }
+    server.ServeStdio();
+    return 0;
+  }
+
+  if(!option.network_file_name.empty()) {
+    maestro::AnalyzeNetwork(option.network_file_name, option.num_alus_per_pe);
+    return 0;
+  }
+
+  if(!maestro::ParseInputs(option.dataflow_file_name, option.layer_file_name, option.dataflow_params)) {
+    return 1;
+  }
+
+  try {
+    if(!maestro::ConfigureProblem()) {
+      return 1;
+    }
+
+    maestro::AnalyzeHardware();
+    maestro::AnalyzeBuffer(true);
+    maestro::AnalyzeReuse();
+    maestro::AnalyzeRuntime(option.num_alus_per_pe, option.do_reduction, option.do_implicit_reduction, option.fg_sync);
+    maestro::AnalyzeRoofline(option.num_alus_per_pe);
+    maestro::AnalyzeEfficiency(option.num_alus_per_pe);
+    maestro::AnalyzeBottleneck();
+    if(option.trace_file_name != "") {
+      maestro::WriteTrace(option.trace_file_name, option.layer_file_name);
+    }
+  }
+  catch(maestro::ArithmeticOverflow& e) {
+    std::cout << std::endl << e.what() << "; the design point is invalid" << std::endl;
+    return 1;
+  }
+
+  if(!option.num_pes_sweep.empty()) {
+    maestro::AnalyzePESweep(option.num_pes_sweep, option.num_alus_per_pe, option.do_reduction, option.do_implicit_reduction, option.fg_sync);
+  }
+
+  if(option.num_chiplets > 1) {
+    maestro::AnalyzeChiplets(option.num_chiplets, option.chiplet_partition, option.interchip_bw, option.interchip_latency,
+                             option.num_alus_per_pe, option.do_reduction, option.do_implicit_reduction, option.fg_sync);
+  }
+
+  if(!option.sweep_file_name.empty()) {
+    maestro::AnalyzeSweep(option);
+  }
 
   return 0;
 }